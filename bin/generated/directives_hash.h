@@ -0,0 +1,5 @@
+/* Generated by tools/gen_perfect_hash.c from directives_list.h - DO NOT EDIT! */
+
+static const unsigned char directives_hash_g[] = {0, 0, 2, 0, 0, 0, 2, 0, 4, 0, 3, 6, 0, 5, 7, 0, 0};
+
+static const perfect_hash_table directives_hash = {2166136265UL, 2166136266UL, 17UL, 8UL, directives_hash_g};
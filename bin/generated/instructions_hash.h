@@ -0,0 +1,5 @@
+/* Generated by tools/gen_perfect_hash.c from instructions_list.h - DO NOT EDIT! */
+
+static const unsigned char instructions_hash_g[] = {0, 0, 0, 0, 22, 9, 0, 0, 0, 0, 0, 0, 0, 0, 0, 13, 0, 0, 21, 24, 25, 16, 0, 0, 18, 0, 2, 16, 0, 24, 1, 23, 0, 12, 19, 4, 9, 0, 0, 0, 5, 19, 0, 11, 6, 0, 10, 0, 23, 13, 0, 0, 0, 19, 15};
+
+static const perfect_hash_table instructions_hash = {2166136261UL, 2166136262UL, 55UL, 27UL, instructions_hash_g};
@@ -0,0 +1,78 @@
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include <stddef.h>
+
+/**
+ * This module implements an arena - a region allocator. Allocations are carved out of big blocks, and are never freed
+ * one by one; Everything is released at once by arena_reset(). Every allocation that lives as long as the compilation
+ * of a single file (symbols, extern uses, images...) comes from the compilation's arena.
+ */
+
+#define ARENA_BLOCK_SIZE 65536 /* The size of a regular block, in bytes */
+
+typedef struct s_arena_block
+{
+    struct s_arena_block *next; /**< The next block in the arena. */
+    size_t capacity;            /**< How many bytes can this block hold? (Not including this header) */
+    size_t used;                /**< How many bytes were already given? */
+} arena_block;
+
+typedef struct s_arena
+{
+    arena_block *blocks; /**< All of the blocks. The first one is the block that allocations are carved from. */
+} arena;
+
+/**
+ * @brief Initializes an empty arena.
+ *
+ * @param arena_p The arena to initialize.
+ */
+void arena_init(arena *arena_p);
+
+/**
+ * @brief Allocates <size> bytes from the given arena. The memory is aligned for every type, and is NOT zeroed.
+ *
+ * @param arena_p The arena.
+ * @param size    How many bytes to allocate?
+ * @return void*  A pointer to the allocated memory, or NULL if there is not enough memory.
+ */
+void *arena_alloc(arena *arena_p, size_t size);
+
+/**
+ * @brief Resizes an allocation of the given arena. If it is the last allocation and there is room, it is resized
+ *        in place; Otherwise a new allocation is made and the old content is copied into it.
+ *
+ * @param arena_p  The arena.
+ * @param ptr      The allocation to resize, or NULL (Then it is just like arena_alloc()).
+ * @param old_size The current size of the allocation.
+ * @param new_size The new size of the allocation.
+ * @return void*   A pointer to the resized allocation, or NULL if there is not enough memory. (Then <ptr> is untouched)
+ */
+void *arena_realloc(arena *arena_p, void *ptr, size_t old_size, size_t new_size);
+
+/**
+ * @brief Moves all of the memory of another arena into the given arena - it is released with it. (For example, an
+ *        arena that a thread allocated from, alone)
+ *
+ * @param arena_p The arena.
+ * @param other_p The other arena. It is left empty.
+ */
+void arena_adopt(arena *arena_p, arena *other_p);
+
+/**
+ * @brief Releases everything that was allocated from the given arena. One regular block is kept, so the next
+ *        compilation does not have to allocate it again.
+ *
+ * @param arena_p The arena.
+ */
+void arena_reset(arena *arena_p);
+
+/**
+ * @brief Releases all of the memory held by the given arena, including the kept block.
+ *
+ * @param arena_p The arena.
+ */
+void arena_free(arena *arena_p);
+
+#endif
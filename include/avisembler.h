@@ -0,0 +1,102 @@
+#ifndef __AVISEMBLER_H__
+#define __AVISEMBLER_H__
+
+#include "arena.h"
+#include "boolean.h"
+#include "pipeline.h"
+#include "diagnostics.h"
+
+#include <stddef.h>
+
+/**
+ * This module is the assembler as a library (libavisembler) - it assembles a source that is already in memory, and
+ * gives the images, the entries, the externals and the diagnostics in memory. Nothing is read from or written to a
+ * file, and nothing is printed.
+ * Everything belongs to an assembler context; A context may be used by one thread at a time, and different contexts
+ * may be used by different threads at the same time.
+ */
+
+typedef enum e_avisembler_status
+{
+    AVISEMBLER_NOT_ENOUGH_MEMORY,
+    AVISEMBLER_PROBLEM_WITH_CODE,
+    AVISEMBLER_OK
+} avisembler_status;
+
+typedef struct s_avisembler_symbol
+{
+    char *name;            /**< The name of the symbol. */
+    unsigned long address; /**< The address of the symbol (Of an entry), or of the instruction that uses it (Of an extern). */
+} avisembler_symbol;
+
+typedef diagnostic avisembler_diagnostic; /* See diagnostics.h */
+
+typedef struct s_avisembler_result
+{
+    unsigned char *code_image;         /**< The code image. NULL if the source has problems. */
+    unsigned long code_address;        /**< The address of the first instruction (IC_DEFAULT_VALUE). */
+    unsigned long icf;                 /**< The ICF. The code image is (icf - code_address) bytes. */
+    unsigned char *data_image;         /**< The data image, without it's runs - read it with avisembler_read_data(). It
+                                            comes right after the code. NULL if the source has problems. */
+    unsigned long dcf;                 /**< The DCF - the size of the data image, with the runs. */
+    data_run *data_runs;               /**< The runs of the data (".space" and ".fill"), which are not expanded. */
+    unsigned long data_runs_count;
+    avisembler_symbol *entries;        /**< The entries, in the order of their definition. */
+    unsigned long entries_count;
+    avisembler_symbol *externals;      /**< Every use of every extern: in the order of the externs, then of the uses. */
+    unsigned long externals_count;
+    avisembler_diagnostic *diagnostics; /**< The problems in the source, in the order that they were found. */
+    unsigned long diagnostics_count;
+} avisembler_result;
+
+typedef struct s_avisembler
+{
+    boolean single_pass;                  /**< Should the source be assembled in a single pass? False by default. */
+    int threads;                          /**< How many threads may the walks use for a big source? 1 by default. */
+    boolean pipelined;                    /**< Should the source be read and parsed by stages on their own threads,
+                                               while the walk (Or the single pass) takes the commands? False by default. */
+    pipeline_stats pipeline_stats;        /**< The counters of the stages, of the last pipelined assembling. */
+
+    /* PRIVATE: */
+    arena arena;                          /**< Everything that the assembling allocates, including the result. */
+    diagnostics diagnostics;              /**< What the current assembling logs - the diagnostics of it's result. */
+} avisembler;
+
+/**
+ * @brief Initializes an assembler context.
+ *
+ * @param assembler_p The context to initialize. SHOULD BE FREED BY avisembler_free().
+ */
+void avisembler_init(avisembler *assembler_p);
+
+/**
+ * @brief Assembles the given source.
+ *
+ * @param assembler_p The context.
+ * @param source      The source. It is only read.
+ * @param size        The size of the source, in bytes.
+ * @param result_p    A pointer to where to put the result. Everything in it belongs to the context, and is valid until
+ *                    the next call with that context (Or until it is freed). The diagnostics are filled even when the
+ *                    returned value is not AVISEMBLER_OK.
+ * @return avisembler_status AVISEMBLER_NOT_ENOUGH_MEMORY or AVISEMBLER_PROBLEM_WITH_CODE or AVISEMBLER_OK.
+ */
+avisembler_status avisembler_assemble(avisembler *assembler_p, char *source, size_t size, avisembler_result *result_p);
+
+/**
+ * @brief Reads bytes of the data image of the given result - the runs are expanded.
+ *
+ * @param result_p The result. It's source must have no problems.
+ * @param offset   The offset of the first byte to read, from the start of the data.
+ * @param length   How many bytes to read? offset + length must be at most the DCF.
+ * @param out      Where to put the bytes. Must be <length> bytes.
+ */
+void avisembler_read_data(avisembler_result *result_p, unsigned long offset, unsigned long length, unsigned char *out);
+
+/**
+ * @brief Frees the given assembler context, and the last result.
+ *
+ * @param assembler_p The context.
+ */
+void avisembler_free(avisembler *assembler_p);
+
+#endif
@@ -6,9 +6,16 @@
  */
 
 #include "boolean.h"
+#include "instructions_table.h"
+#include "directives_table.h"
 
 #define LABEL_MAX_LENGTH 31
 
+#define LINE_MAX_LENGTH 80
+
+/* A command needs a whitespace after it's name, and a comma between every two operands */
+#define OPERANDS_MAX_COUNT (LINE_MAX_LENGTH / 2)
+
 typedef enum e_command_type
 {
     DIRECTIVE,  /* For example: .entry LABEL */
@@ -21,15 +28,28 @@ typedef struct s_command
     command_type type;                /**< Tye type of the command */
     char **operands;                  /**< All the operands of the command. NULL if there are no operands. */
     int number_of_operands;           /**< The length of the operands array */
+    long *values;                     /**< The values of the register and constant operands, that the validator put
+                                           (Of "$3" - 3). The others are undefined. NULL if there are no operands. */
     char *command_name;               /**< The name of the command (For example - "addi") */
+    instruction *inst;                /**< The instruction of the command, that the validator resolved. NULL if it is a
+                                           directive (Or if it was not validated). */
+    directive *dir;                   /**< The directive of the command, that the validator resolved. NULL if it is an
+                                           instruction (Or if it was not validated). */
     char label[LABEL_MAX_LENGTH + 1]; /**< The label of that line; Empty string if there is no label. */
-
-    /**< The parser might exit early, with errors. These variables indicate what memory was allready allocated and needs
-     *   to be freed, and what should not be freed - because it was never allocated */
-    boolean operands_array_allocated, command_name_allocated;
-    int number_of_operands_allocated;
 } command;
 
+/**
+ * The memory of a parsed command. The parser cuts the line in place - the command name and then the operands are packed
+ * at it's start, each with a terminating zero - and the command points into it. So nothing is allocated for a command,
+ * and the buffer must live as long as the command is used.
+ */
+typedef struct s_command_buffer
+{
+    char line[LINE_MAX_LENGTH + 1];     /**< The line. After the parsing - the command name and the operands. */
+    char *operands[OPERANDS_MAX_COUNT]; /**< The operands array of the command. */
+    long values[OPERANDS_MAX_COUNT];    /**< The values array of the command. */
+} command_buffer;
+
 /**
  * Checks if the given command has a label.
  * @param cmd The command to check.
@@ -38,10 +58,13 @@ typedef struct s_command
 boolean command_has_label(command cmd);
 
 /**
- * @brief Frees the command's allocated memory. (Some of the command's fields are dynamically allocated..)
+ * @brief Points the command name, the operands and the values of the given command into the given buffer, whose line
+ *        holds them packed (As the parser leaves it). Used when the packed line (And the values) were copied to another
+ *        buffer.
  * 
- * @param cmd The command to free.
+ * @param cmd_p    The command. It's number_of_operands must be set.
+ * @param buffer_p The buffer.
  */
-void free_command(command cmd);
+void command_link(command *cmd_p, command_buffer *buffer_p);
 
 #endif
\ No newline at end of file
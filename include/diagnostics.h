@@ -0,0 +1,73 @@
+#ifndef __DIAGNOSTICS_H__
+#define __DIAGNOSTICS_H__
+
+#include "logger.h"
+#include "arena.h"
+#include "boolean.h"
+
+/**
+ * This module keeps the messages of the log aside, as diagnostics - so they can be given to a caller (Like the
+ * library does), or logged again later, in another order (Like the chunks of the first walk are).
+ */
+
+#define DIAGNOSTICS_MIN_CAPACITY 16
+
+typedef struct s_diagnostic
+{
+    char *module;  /**< The module that found the problem (For example - "parser"). A static string. NULL if it does not
+                        belong to a line. */
+    char *type;    /**< The type of the problem (For example - "syntax error"). A static string. */
+    int line;      /**< On what line is the problem? */
+    char *message; /**< The message itself. */
+} diagnostic;
+
+typedef struct s_diagnostics
+{
+    diagnostic *items;      /**< The diagnostics, in the order that they were logged. */
+    unsigned long count;
+    unsigned long capacity; /**< The allocated length of the items array. */
+    arena *arena_p;         /**< The arena that the items and the messages are allocated from. */
+    boolean out_of_memory;  /**< Was a diagnostic lost, because there was not enough memory? */
+    logger_sink sink;       /**< The sink that sends the log to this buffer (See diagnostics_redirect()). */
+} diagnostics;
+
+/**
+ * @brief Initializes an empty diagnostics buffer.
+ *
+ * @param diagnostics_p A pointer to the buffer.
+ * @param arena_p       The arena to allocate the diagnostics from. They live until this arena is reset.
+ */
+void diagnostics_init(diagnostics *diagnostics_p, arena *arena_p);
+
+/**
+ * @brief Keeps the given message as a diagnostic. A logger_handler - it's context is the diagnostics buffer. If there
+ *        is not enough memory, the message is lost, and out_of_memory is set.
+ *
+ * @param context A pointer to the diagnostics buffer.
+ * @param module  The module that logged the message.
+ * @param type    The type of the message.
+ * @param line    The line of the message.
+ * @param message The formatted message.
+ */
+void diagnostics_add(void *context, char *module, char *type, int line, char *message);
+
+/**
+ * @brief Sends the messages of the calling thread to the given buffer.
+ *
+ * @param diagnostics_p A pointer to the buffer. It must stay valid until the messages are sent back.
+ * @return logger_sink* The previous sink of the calling thread (For logger_redirect(), to send the messages back).
+ */
+logger_sink *diagnostics_redirect(diagnostics *diagnostics_p);
+
+/**
+ * @brief Logs the given diagnostics again, from *next_p, up to (And including) the given line.
+ *
+ * @param items       The diagnostics.
+ * @param count       How many diagnostics are there?
+ * @param next_p      A pointer to the index of the next diagnostic to log. It is advanced.
+ * @param last_line   The last line to log the diagnostics of.
+ * @param line_offset Added to the line of every diagnostic. (For example - the line that a chunk starts after)
+ */
+void diagnostics_replay(diagnostic *items, unsigned long count, unsigned long *next_p, int last_line, int line_offset);
+
+#endif
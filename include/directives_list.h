@@ -0,0 +1,15 @@
+/**
+ * The list of all of the directives: DIRECTIVE(id, name, number of operands, operands types).
+ * This file has no include guard on purpose - It is included by directives_table.h to build the ids enum, by directives_table.c
+ * to build the directives table, and by the perfect hash generator (tools/gen_perfect_hash.c), each time with a different
+ * definition of DIRECTIVE.
+ */
+
+DIRECTIVE(DB, "db", DT_INFINITY, constant_byte_arr)
+DIRECTIVE(DH, "dh", DT_INFINITY, constant_half_arr)
+DIRECTIVE(DW, "dw", DT_INFINITY, constant_word_arr)
+DIRECTIVE(ASCIZ, "asciz", 1, string_arr)
+DIRECTIVE(SPACE, "space", 1, space_arr)
+DIRECTIVE(FILL, "fill", 3, fill_arr)
+DIRECTIVE(ENTRY, "entry", 1, label_arr)
+DIRECTIVE(EXTERN, "extern", 1, label_arr)
@@ -12,8 +12,19 @@ typedef enum e_directives_table_status
     DT_OK
 } directives_table_status;
 
+/* A dense id of every directive (DIRECTIVE_DB, ...), in the order of directives_list.h - for a switch, instead of
+   comparing names */
+#define DIRECTIVE(id, name, number_of_operands, operands_types) DIRECTIVE_##id,
+typedef enum e_directive_id
+{
+#include "directives_list.h"
+    DIRECTIVES_COUNT
+} directive_id;
+#undef DIRECTIVE
+
 typedef struct s_directive
 {
+    directive_id id;              /**< The id of the directive. For example - DIRECTIVE_DB. */
     char *name;                   /**< The name of the directive */
     int number_of_operands;       /**< How many operands does this directive get? DT_INFINITY means one operand in the array, but the directive gets infinity number of operands of this types. */
     operand_type *operands_types; /**< An array of operands types, of length number_of_operands. */
@@ -3,7 +3,7 @@
 
 /* The final module - Writes all of the generated data to a file! */
 
-#include "walk.h"
+#include "avisembler.h"
 
 typedef enum e_file_writer_status
 {
@@ -16,30 +16,36 @@ typedef enum e_file_writer_status
  * @brief Creates and object file.
  * 
  * @param original_file_name  The name of the original input file. MUST END WITH ".as"!
- * @param data_image          A pointer to the data image.
- * @param dcf_p               The DCF
- * @param code_image          A pointer to the code image.
- * @param icf_p               The ICF
+ * @param result_p            The result of the assembling - the images.
  * @return file_writer_status FILE_WRITER_IO_ERROR or FILE_WRITER_OK.
  */
-file_writer_status write_object_file(char* original_file_name, unsigned char *data_image, unsigned long dcf, unsigned char *code_image, unsigned long icf);
+file_writer_status write_object_file(char* original_file_name, avisembler_result *result_p);
 
 /**
  * @brief Creates an entries files.
  * 
  * @param original_file_name  The name of the original input file. MUST END WITH ".as"!
- * @param st                  The symbols table.
+ * @param result_p            The result of the assembling - the entries.
  * @return file_writer_status FILE_WRITER_IO_ERROR or FILE_WRITER_OK.
  */
-file_writer_status write_entries_file(char* original_file_name, symbols_table st);
+file_writer_status write_entries_file(char* original_file_name, avisembler_result *result_p);
 
 /**
  * @brief Creates an externals files.
  * 
  * @param original_file_name  The name of the original input file. MUST END WITH ".as"!
- * @param st                  The symbols table.
+ * @param result_p            The result of the assembling - the externals.
  * @return file_writer_status FILE_WRITER_IO_ERROR or FILE_WRITER_OK.
  */
-file_writer_status write_externals_file(char* original_file_name, symbols_table st);
+file_writer_status write_externals_file(char* original_file_name, avisembler_result *result_p);
 
-#endif
\ No newline at end of file
+/**
+ * @brief Creates a binary object file (".obb"). See obb.h for the format.
+ * 
+ * @param original_file_name  The name of the original input file. MUST END WITH ".as"!
+ * @param result_p            The result of the assembling - the images, the entries and the externals.
+ * @return file_writer_status FILE_WRITER_IO_ERROR or FILE_WRITER_NOT_ENOUGH_MEMORY or FILE_WRITER_OK.
+ */
+file_writer_status write_binary_object_file(char* original_file_name, avisembler_result *result_p);
+
+#endif
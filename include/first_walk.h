@@ -1,16 +1,42 @@
 #ifndef __FIRST_WALK_H__
 #define __FIRST_WALK_H__
 
-#include "linked_list.h"
 #include "walk.h"
+#include "arena.h"
+#include "source_file.h"
+#include "ir.h"
+#include "pipeline.h"
 
 /**
- * @brief This method does the first walk - creates a symbols table from the given file.
+ * @brief This method does the first walk - creates a symbols table from the given source, and saves every valid
+ *        command in the IR, for the second walk.
  * 
- * @param file_name The file to compile.
- * @param symbols_table Will point to the symbol table. SHOULD BE FREED BY linked_list_free(), and it's symbols should be freed.
- * @return walk_status WALK_IO_ERROR or WALK_NOT_ENOUGH_MEMORY or WALK_PROBLEM_WITH_CODE or WALK_OK.
+ * @param source The source to compile.
+ * @param symbols_table_p A pointer to an empty symbols table, which will be filled.
+ * @param program A pointer to an empty IR, which will be filled.
+ * @param arena_p The compilation's arena. The symbols are allocated from it.
+ * @param threads How many threads may parse the source? A big source is split into newline-aligned chunks, which are
+ *                parsed and validated in parallel; The result (And the order of the messages) is the same.
+ * @param pipeline_p A started pipeline of the source, to take the commands from; Or NULL to read the source here.
+ * @param icf_p A pointer to where to put the program counter after the last command - the ICF, if the source is valid.
+ * @param dcf_p A pointer to where to put the data counter after the last command - the DCF, if the source is valid.
+ * @return walk_status WALK_NOT_ENOUGH_MEMORY or WALK_PROBLEM_WITH_CODE or WALK_OK.
  */
-walk_status first_walk(char* file_name, symbols_table* symbols_table_p);
+walk_status first_walk(source_file* source, symbols_table* symbols_table_p, ir *program, arena *arena_p, int threads, pipeline *pipeline_p, unsigned long *icf_p, unsigned long *dcf_p);
+
+/**
+ * @brief Puts the symbol of the given command (If exist) in the symbols table - it's label, or the label that it
+ *        declares extern. Logs if the label was already defined.
+ * 
+ * @param cmd The command. MUST BE VALIDATED.
+ * @param symbols_table_p A pointer to the symbols table to insert into.
+ * @param pc  Current program counter
+ * @param dc  Current data counter
+ * @param line On what line is this command is?
+ * @param arena_p The arena to allocate the symbol from.
+ * @param symbol_pp A pointer to where to put the new symbol, or NULL if no symbol was put.
+ * @return WALK_NOT_ENOUGH_MEMORY or WALK_PROBLEM_WITH_CODE or WALK_OK.
+ */
+walk_status put_symbol(command cmd, symbols_table *symbols_table_p, unsigned long pc, unsigned long dc, int line, arena *arena_p, symbol **symbol_pp);
 
 #endif
\ No newline at end of file
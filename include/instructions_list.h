@@ -0,0 +1,34 @@
+/**
+ * The list of all of the instructions: INSTRUCTION(id, name, type, funct, opcode, number of operands, operands types).
+ * This file has no include guard on purpose - It is included by instructions_table.h to build the ids enum, by instructions_table.c
+ * to build the instructions table, and by the perfect hash generator (tools/gen_perfect_hash.c), each time with a different
+ * definition of INSTRUCTION.
+ */
+
+INSTRUCTION(ADD, "add", R, 1, 0, 3, three_registers_operands_types)
+INSTRUCTION(SUB, "sub", R, 2, 0, 3, three_registers_operands_types)
+INSTRUCTION(AND, "and", R, 3, 0, 3, three_registers_operands_types)
+INSTRUCTION(OR, "or", R, 4, 0, 3, three_registers_operands_types)
+INSTRUCTION(NOR, "nor", R, 5, 0, 3, three_registers_operands_types)
+INSTRUCTION(MOVE, "move", R, 1, 1, 2, two_registers_operands_types)
+INSTRUCTION(MVHI, "mvhi", R, 2, 1, 2, two_registers_operands_types)
+INSTRUCTION(MVLO, "mvlo", R, 3, 1, 2, two_registers_operands_types)
+INSTRUCTION(ADDI, "addi", I, 0, 10, 3, arithmetics_logics_operands_types)
+INSTRUCTION(SUBI, "subi", I, 0, 11, 3, arithmetics_logics_operands_types)
+INSTRUCTION(ANDI, "andi", I, 0, 12, 3, arithmetics_logics_operands_types)
+INSTRUCTION(ORI, "ori", I, 0, 13, 3, arithmetics_logics_operands_types)
+INSTRUCTION(NORI, "nori", I, 0, 14, 3, arithmetics_logics_operands_types)
+INSTRUCTION(BNE, "bne", I, 0, 15, 3, conditional_jumps_operands_types)
+INSTRUCTION(BEQ, "beq", I, 0, 16, 3, conditional_jumps_operands_types)
+INSTRUCTION(BLT, "blt", I, 0, 17, 3, conditional_jumps_operands_types)
+INSTRUCTION(BGT, "bgt", I, 0, 18, 3, conditional_jumps_operands_types)
+INSTRUCTION(LB, "lb", I, 0, 19, 3, memory_instructions_operands_types)
+INSTRUCTION(SB, "sb", I, 0, 20, 3, memory_instructions_operands_types)
+INSTRUCTION(LW, "lw", I, 0, 21, 3, memory_instructions_operands_types)
+INSTRUCTION(SW, "sw", I, 0, 22, 3, memory_instructions_operands_types)
+INSTRUCTION(LH, "lh", I, 0, 23, 3, memory_instructions_operands_types)
+INSTRUCTION(SH, "sh", I, 0, 24, 3, memory_instructions_operands_types)
+INSTRUCTION(JMP, "jmp", J, 0, 30, 1, register_or_label_operand_type)
+INSTRUCTION(LA, "la", J, 0, 31, 1, label_operand_type)
+INSTRUCTION(CALL, "call", J, 0, 32, 1, label_operand_type)
+INSTRUCTION(STOP, "stop", J, 0, 63, 0, NULL)
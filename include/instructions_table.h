@@ -14,8 +14,19 @@ typedef enum e_instruction_type
     J
 } instruction_type;
 
+/* A dense id of every instruction (INSTRUCTION_ADD, ...), in the order of instructions_list.h - for a switch, instead of
+   comparing names */
+#define INSTRUCTION(id, name, type, funct, opcode, number_of_operands, operands_types) INSTRUCTION_##id,
+typedef enum e_instruction_id
+{
+#include "instructions_list.h"
+    INSTRUCTIONS_COUNT
+} instruction_id;
+#undef INSTRUCTION
+
 typedef struct s_instruction
 {
+    instruction_id id;            /**< The id of this instruction. For example - INSTRUCTION_ADD. */
     char* name;                   /**< The name of this instruction. For example = "add". */
 
     instruction_type type;        /**< The type of this instruction - R or I or J. */
@@ -41,4 +52,4 @@ typedef enum e_instructions_table_status
  */
 instructions_table_status instructions_table_get_instruction(char *name, instruction **inst);
 
-#endif
\ No newline at end of file
+#endif
\ No newline at end of file
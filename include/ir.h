@@ -0,0 +1,142 @@
+#ifndef __IR_H__
+#define __IR_H__
+
+#include "command.h"
+#include "instructions_table.h"
+#include "arena.h"
+
+/**
+ * This module implements the intermediate representation (IR) - the validated commands of a source, as the first walk
+ * read them, so the second walk does not have to read and parse the source again. The records are kept in a
+ * contiguous array, and their operands array and strings are packed right after their values; Everything comes from an arena, so
+ * there is nothing to free.
+ * The instructions are also kept decoded, column by column (See ir_instructions), so they can be encoded in bulk.
+ */
+
+typedef enum e_ir_status
+{
+    IR_NOT_ENOUGH_MEMORY,
+    IR_OK
+} ir_status;
+
+typedef struct s_ir_record
+{
+    command_type type;      /**< The type of the command. */
+    char *command_name;     /**< The name of the command (For example - "addi"). */
+    instruction *inst;      /**< The instruction of the command. NULL if it is a directive. */
+    directive *dir;         /**< The directive of the command. NULL if it is an instruction. */
+    char *label;            /**< The label of the command; Empty string if there is no label. */
+    char **operands;        /**< All the operands of the command. NULL if there are no operands. */
+    long *values;           /**< The values of the register and constant operands (See command). NULL if there are no operands. */
+    int number_of_operands; /**< The length of the operands array. */
+    int line;               /**< On what line is the command? */
+    unsigned long pc;       /**< The program counter of the command. */
+    unsigned long dc;       /**< The data counter of the command. */
+} ir_record;
+
+typedef struct s_ir_label_use
+{
+    unsigned long index;   /**< The index of the instruction that uses the label (Among the instructions). */
+    instruction_type type; /**< The type of that instruction - I (A conditional jump) or J. */
+    char *label;           /**< The label. */
+} ir_label_use;
+
+/**
+ * The decoded instructions, in the order of the lines: The i'th instruction is at IC_DEFAULT_VALUE + i * INSTRUCTION_SIZE,
+ * and each of it's fields is in it's own array, at index i. A field that the instruction does not have is 0.
+ */
+typedef struct s_ir_instructions
+{
+    unsigned char *ids;        /**< The instruction_id of every instruction. */
+    unsigned char *rs;         /**< The rs of every instruction. */
+    unsigned char *rt;         /**< The rt of every instruction. */
+    unsigned char *rd;         /**< The rd of every instruction. */
+    unsigned long *immeds;     /**< The low field of every instruction, already cut to it's width and in place: The immed
+                                    of an I instruction, or the reg bit and the address of a J instruction. The field of a
+                                    label is left 0 - it is put when the labels are known. */
+    unsigned long length;      /**< How many instructions are there? */
+    unsigned long capacity;    /**< The allocated length of the fields arrays. */
+    ir_label_use *label_uses;  /**< The uses of labels, in the order of the instructions. */
+    unsigned long label_uses_count;
+    unsigned long label_uses_capacity;
+} ir_instructions;
+
+typedef struct s_ir
+{
+    ir_record *records;            /**< The records, in the order of the lines. */
+    unsigned long length;          /**< How many records are there? */
+    unsigned long capacity;        /**< The allocated length of the records array. */
+    ir_instructions instructions;  /**< The instructions of the records, decoded. */
+    unsigned long data_runs_count; /**< How many of the records reserve a run of data? (See data_run) */
+    unsigned long data_runs_size;  /**< How many bytes do these runs take? */
+    arena *arena_p;                /**< The arena that the IR allocates from. */
+} ir;
+
+/**
+ * @brief Initializes an empty IR.
+ *
+ * @param ir_p    A pointer to the IR.
+ * @param arena_p The arena to allocate the IR from. The IR lives until this arena is reset.
+ */
+void ir_init(ir *ir_p, arena *arena_p);
+
+/**
+ * @brief Appends a record of the given command to the IR. The command's strings and values are copied. An instruction
+ *        is also decoded to the instructions of the IR.
+ *
+ * @param ir_p   A pointer to the IR.
+ * @param cmd    The command. MUST BE VALIDATED.
+ * @param line   On what line is the command?
+ * @param pc     The program counter of the command.
+ * @param dc     The data counter of the command.
+ * @return ir_status IR_NOT_ENOUGH_MEMORY or IR_OK.
+ */
+ir_status ir_append(ir *ir_p, command cmd, int line, unsigned long pc, unsigned long dc);
+
+/**
+ * @brief Appends copies of the records and of the instructions of another IR to the IR. Their strings are NOT copied -
+ *        they must live as long as the IR.
+ *
+ * @param ir_p    A pointer to the IR.
+ * @param other_p A pointer to the other IR.
+ * @return ir_status IR_NOT_ENOUGH_MEMORY or IR_OK.
+ */
+ir_status ir_append_ir(ir *ir_p, ir *other_p);
+
+/**
+ * @brief Returns how many records are in the IR.
+ *
+ * @param ir_p A pointer to the IR.
+ * @return unsigned long The number of records.
+ */
+unsigned long ir_length(ir *ir_p);
+
+/**
+ * @brief Returns the record at the given index.
+ *
+ * @param ir_p  A pointer to the IR.
+ * @param index The index of the record. Must be less than ir_length().
+ * @return ir_record* The record.
+ */
+ir_record *ir_get(ir *ir_p, unsigned long index);
+
+/**
+ * @brief Fills a record that views the given command, without copying it. It is valid as long as the command is.
+ *
+ * @param record A pointer to the record to fill.
+ * @param cmd_p  A pointer to the command. MUST BE VALIDATED.
+ * @param line   On what line is the command?
+ * @param pc     The program counter of the command.
+ * @param dc     The data counter of the command.
+ */
+void ir_record_view(ir_record *record, command *cmd_p, int line, unsigned long pc, unsigned long dc);
+
+/**
+ * @brief Fills a command that views the given record, without copying it (But the label). It must not be freed.
+ *
+ * @param record A pointer to the record.
+ * @param cmd_p  A pointer to the command to fill.
+ */
+void ir_record_command(ir_record *record, command *cmd_p);
+
+#endif
@@ -2,18 +2,39 @@
 #define _LINKED_LIST_H
 
 #include "boolean.h"
+#include "arena.h"
 
 /**
- * This module implements a simple linked list.
+ * This module implements a simple linked list, with O(1) append and length. The nodes are allocated from the list's
+ * own slab - batches of nodes carved out of an arena - so there is nothing to free.
+ * To go over the list, use a linked_list_iterator.
  */
 
+#define LINKED_LIST_MIN_SLAB_NODES 4   /* How many nodes does the first batch hold? */
+#define LINKED_LIST_MAX_SLAB_NODES 256 /* Every batch doubles, until this size */
+
 typedef struct s_node
 {
     void *data; /**< The data of this node */
     struct s_node *next; /**< A pointer to the next node in the linked list */
 } node;
 
-typedef node *linked_list;
+typedef struct s_linked_list
+{
+    node *head;          /**< The first node; NULL when the list is empty. */
+    node *tail;          /**< The last node; NULL when the list is empty. */
+    int length;          /**< How many nodes are in the list? */
+
+    arena *arena_p;      /**< The arena that the slab takes it's batches from. */
+    node *slab;          /**< The next free node in the current batch. */
+    int slab_left;       /**< How many free nodes are left in the current batch? */
+    int slab_batch_size; /**< The size of the last batch that was taken. */
+} linked_list;
+
+typedef struct s_linked_list_iterator
+{
+    node *current; /**< The node that will be returned next; NULL at the end of the list. */
+} linked_list_iterator;
 
 typedef enum e_linked_list_status
 {
@@ -23,10 +44,11 @@ typedef enum e_linked_list_status
 } linked_list_status;
 
 /**
- * Creates an empty linked_list.
- * @return The empty linked_list.
+ * Initializes an empty linked_list.
+ * @param l       The linked_list to initialize.
+ * @param arena_p The arena to allocate the nodes from.
  */
-linked_list linked_list_create();
+void linked_list_init(linked_list *l, arena *arena_p);
 
 /**
  * Appends a new entry to the end of the given linked_list.
@@ -34,20 +56,7 @@ linked_list linked_list_create();
  * @param data        The data to append.
  * @return            LINKED_LIST_NOT_ENOUGH_MEMORY or LINKED_LIST_OK.
  */
-linked_list_status linked_list_append(linked_list *d, void *data);
-
-/**
- * Free's the memory taken by the given linked_list. (Doesn't realese the data.)
- * @param l The linked_list to realese.
- */
-void linked_list_free(linked_list l);
-
-/**
- * @brief Free's the elements inside of the array. (Runs free() on everyone of them).
- * 
- * @param l The linked list to release it's elements.
- */
-void linked_list_free_elements(linked_list l);
+linked_list_status linked_list_append(linked_list *l, void *data);
 
 /**
  * @brief Returns the length of the given linked list
@@ -55,15 +64,23 @@ void linked_list_free_elements(linked_list l);
  * @param l    The linked list
  * @return int The length
  */
-int linked_list_length(linked_list l);
+int linked_list_length(linked_list *l);
 
 /**
- * @brief Returns linked_list[index]
- * 
- * @param index  The index
- * @param l      The linked list.
- * @return void* The data at linked_list[index]. If the index is out of bounds - returns null.
+ * @brief Initializes an iterator that starts from the first entry of the given linked list.
+ *
+ * @param it The iterator to initialize.
+ * @param l  The linked list.
+ */
+void linked_list_iterator_init(linked_list_iterator *it, linked_list *l);
+
+/**
+ * @brief Gives the next entry of the iterator, and advances it.
+ *
+ * @param it       The iterator.
+ * @param data     A pointer to where to put the data of the entry.
+ * @return boolean false if there are no more entries (then data is untouched); Else - true.
  */
-void* linked_list_get(linked_list l, int index);
+boolean linked_list_iterator_next(linked_list_iterator *it, void **data);
 
-#endif
\ No newline at end of file
+#endif
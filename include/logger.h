@@ -1,6 +1,34 @@
 #ifndef _LOGGER_H
 #define _LOGGER_H
 
+#include <stdio.h>
+
+/**
+ * The messages go to the standard output. A thread may redirect it's own messages to another sink - a stream (For
+ * example, when some files are compiled in parallel, and the messages of every file should be printed together), or a
+ * handler that gets every message as it's parts (For example, the library keeps them as diagnostics).
+ */
+
+#define LOGGER_MESSAGE_MAX_LENGTH 512 /* A message that is given to a handler is cut after it */
+
+/**
+ * Handles a message of the log.
+ * @param context    The context that was given with the handler.
+ * @param module     The name of the module that printed that message, or NULL if it does not belong to a line of code.
+ *                   (The names and the types are static strings)
+ * @param type       The type of the log message, or NULL.
+ * @param line       The number of the line of code, or 0.
+ * @param message    The formatted message. It is valid only during the call.
+ */
+typedef void (*logger_handler)(void* context, char* module, char* type, int line, char* message);
+
+typedef struct s_logger_sink
+{
+    FILE* stream;           /**< Where to print the messages. If it is NULL, they are given to the handler. */
+    logger_handler handler; /**< Gets the messages when there is no stream. */
+    void* context;          /**< Given to the handler. */
+} logger_sink;
+
 /**
  * Prints a message to the log.
  * @param module     The name of the module that prints that message. (For example - "parser").
@@ -11,4 +39,18 @@
  */
 void logger_log(char* module, char* type, int line, char* message, ...);
 
-#endif
\ No newline at end of file
+/**
+ * Prints a message that does not belong to a line of code, as it is. (For example - "Error: Not enough memory!\n").
+ * @param message    The message itself.
+ * @param argumants  The additional argumants that should be inserted into the message. (printf style)
+ */
+void logger_print(char* message, ...);
+
+/**
+ * Sends the messages of the calling thread to the given sink.
+ * @param sink_p     The sink (It must stay valid while it is used), or NULL to send them back to the standard output.
+ * @return The previous sink of the calling thread, or NULL if it was the standard output.
+ */
+logger_sink* logger_redirect(logger_sink* sink_p);
+
+#endif
@@ -0,0 +1,129 @@
+#ifndef __OBB_H__
+#define __OBB_H__
+
+#include "boolean.h"
+#include "command.h"
+#include "source_file.h"
+
+#include <stddef.h>
+
+/**
+ * This module defines the binary object format (".obb"), and reads it. An ".obb" file is made of:
+ *   1. A header of OBB_HEADER_SIZE bytes.
+ *   2. The code image, and right after it the data image - the same bytes that the ".ob" file shows in hex.
+ *   3. Padding with zeros, up to a multiple of OBB_ALIGNMENT bytes.
+ *   4. The entries table, and then the externals table - if their flags are set. They have the same rows as the
+ *      ".ent" and ".ext" files, in the same order. Every row is OBB_SYMBOL_ROW_SIZE bytes: the address, and then the
+ *      name, padded with '\0'.
+ * All of the numbers are 32 bit, little endian. Every part starts on an aligned offset, so the file can be mapped and
+ * used as it is.
+ */
+
+#define OBB_MAGIC      "AOBB"
+#define OBB_MAGIC_SIZE 4
+#define OBB_VERSION    1
+
+#define OBB_HEADER_SIZE      32
+#define OBB_ALIGNMENT        4
+#define OBB_SYMBOL_NAME_SIZE (LABEL_MAX_LENGTH + 1)
+#define OBB_SYMBOL_ROW_SIZE  (4 + OBB_SYMBOL_NAME_SIZE)
+
+#define OBB_FLAG_ENTRIES   1 /* The file has an entries table */
+#define OBB_FLAG_EXTERNALS 2 /* The file has an externals table */
+
+typedef enum e_obb_status
+{
+    OBB_IO_ERROR,
+    OBB_NOT_ENOUGH_MEMORY,
+    OBB_INVALID,
+    OBB_OK
+} obb_status;
+
+typedef struct s_obb_header
+{
+    unsigned long version;         /**< The version of the format. */
+    unsigned long flags;           /**< OBB_FLAG_ENTRIES and/or OBB_FLAG_EXTERNALS. */
+    unsigned long code_address;    /**< The address of the first instruction (IC_DEFAULT_VALUE). */
+    unsigned long icf;             /**< The ICF. The code image is (icf - code_address) bytes. */
+    unsigned long dcf;             /**< The DCF - the size of the data image. */
+    unsigned long entries_count;   /**< How many rows are in the entries table? */
+    unsigned long externals_count; /**< How many rows are in the externals table? */
+} obb_header;
+
+typedef struct s_obb_symbol
+{
+    char *name;            /**< The name of the symbol. Points into the file. */
+    unsigned long address; /**< The address. */
+} obb_symbol;
+
+typedef struct s_obb_file
+{
+    source_file source;             /**< The content of the file. */
+    obb_header header;              /**< The decoded header. */
+    unsigned char *code_image;      /**< The code image. Points into the file. */
+    unsigned char *data_image;      /**< The data image. Points into the file. */
+    unsigned char *entries_table;   /**< The entries table. Points into the file. NULL if there is no such table. */
+    unsigned char *externals_table; /**< The externals table. Points into the file. NULL if there is no such table. */
+} obb_file;
+
+/**
+ * @brief Encodes the given header.
+ *
+ * @param header The header.
+ * @param out    Where to put the encoded header. Must be OBB_HEADER_SIZE bytes.
+ */
+void obb_encode_header(obb_header *header, unsigned char *out);
+
+/**
+ * @brief Encodes a row of the entries table or of the externals table.
+ *
+ * @param name    The name of the symbol. It is cut after OBB_SYMBOL_NAME_SIZE - 1 chars.
+ * @param address The address.
+ * @param out     Where to put the encoded row. Must be OBB_SYMBOL_ROW_SIZE bytes.
+ */
+void obb_encode_symbol_row(char *name, unsigned long address, unsigned char *out);
+
+/**
+ * @brief How many bytes of padding come after the images?
+ *
+ * @param header The header.
+ * @return size_t The size of the padding.
+ */
+size_t obb_padding_size(obb_header *header);
+
+/**
+ * @brief Opens and checks the given ".obb" file. The file is mapped (Or read), and it's parts are given as pointers
+ *        into it.
+ *
+ * @param file_name The name of the file.
+ * @param obb_p     A pointer to where to put the opened file. SHOULD BE CLOSED BY obb_close().
+ * @return obb_status OBB_IO_ERROR or OBB_NOT_ENOUGH_MEMORY or OBB_INVALID or OBB_OK.
+ */
+obb_status obb_open(char *file_name, obb_file *obb_p);
+
+/**
+ * @brief Gives a row of the entries table.
+ *
+ * @param obb_p    The file. Must have an entries table.
+ * @param index    The index of the row. Must be less than header.entries_count.
+ * @param symbol_p A pointer to where to put the row.
+ */
+void obb_get_entry(obb_file *obb_p, unsigned long index, obb_symbol *symbol_p);
+
+/**
+ * @brief Gives a row of the externals table.
+ *
+ * @param obb_p    The file. Must have an externals table.
+ * @param index    The index of the row. Must be less than header.externals_count.
+ * @param symbol_p A pointer to where to put the row.
+ */
+void obb_get_external(obb_file *obb_p, unsigned long index, obb_symbol *symbol_p);
+
+/**
+ * @brief Closes the given file. The pointers into it become invalid.
+ *
+ * @param obb_p The file.
+ */
+void obb_close(obb_file *obb_p);
+
+#endif
@@ -7,8 +7,8 @@
 /* This module holds of the operands validation functions */
 
 /**
- * Checks if the operands of the given command are valid.
- * @param cmd  The commnad to check. The command name must exist.
+ * Checks if the operands of the given command are valid, and puts the values of it's registers and constants.
+ * @param cmd  The commnad to check. The command name must be resolved (It's inst or dir set). It's values are put in the array that it points to.
  * @param line On what line these operands are?
  * @return VALIDATOR_INVALID or VALIDATOR_OK.
  */
@@ -11,18 +11,18 @@ typedef enum e_parser_status
 {
     PARSER_SYNTAX_ERROR,
     PARSER_EMPTY,
-    PARSER_NOT_ENOUGH_MEMORY,
     PARSER_OVERFLOW, /* When the label/line is too long */
     PARSER_OK
 } parser_status;
 
 /**
- * Parses the given string.
- * @param str  The string to parse.
- * @param cmd  A pointer to a command struct to store inside the data. After usage, should be freed using command.h:free_command()
- * @param line On what line is this string?
- * @return PARSER_SYNTAX_ERROR or PARSER_EMPTY or PARSER_OVERFLOW or PARSER_NOT_ENOUGH_MEMORY or PARSER_OK.
+ * Parses the line of the given buffer. Nothing is allocated - the line is cut in place, and the command points into
+ * the buffer.
+ * @param buffer_p The buffer, with the line to parse. The line is changed!
+ * @param cmd      A pointer to a command struct to store inside the data. Valid as long as the buffer is.
+ * @param line     On what line is this string?
+ * @return PARSER_SYNTAX_ERROR or PARSER_EMPTY or PARSER_OVERFLOW or PARSER_OK.
  */
-parser_status parser_parse(char *str, command *cmd, int line);
+parser_status parser_parse(command_buffer *buffer_p, command *cmd, int line);
 
 #endif
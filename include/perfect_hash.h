@@ -0,0 +1,43 @@
+#ifndef __PERFECT_HASH_H__
+#define __PERFECT_HASH_H__
+
+/**
+ * This module implements lookups in minimal perfect hash tables (The CHM algorithm). The tables are generated at
+ * build time by tools/gen_perfect_hash.c, from the lists of the instructions and of the directives.
+ *
+ * Each key is hashed twice (with two seeds) into the vertices of an acyclic graph. g[] is chosen by the generator so
+ * that (g[h1] + g[h2]) % number_of_keys is exactly the index of the key in it's list - So the index can be used
+ * directly in the original array, and only one strcmp() is needed to reject strings that are not keys.
+ */
+
+typedef struct s_perfect_hash_table
+{
+    unsigned long seed1;        /**< The seed of the first hash function. */
+    unsigned long seed2;        /**< The seed of the second hash function. */
+    unsigned long vertices;     /**< The number of vertices in the graph - The length of g. */
+    unsigned long keys;         /**< The number of keys in the table. */
+    const unsigned char *g;     /**< The value of every vertex. */
+} perfect_hash_table;
+
+/**
+ * @brief Hashes the given string with the given two seeds, in one pass over the string.
+ *
+ * @param str   The string to hash.
+ * @param seed1 The seed of the first hash.
+ * @param seed2 The seed of the second hash.
+ * @param h1    A pointer to where to put the first hash.
+ * @param h2    A pointer to where to put the second hash.
+ */
+void perfect_hash_string(char *str, unsigned long seed1, unsigned long seed2, unsigned long *h1, unsigned long *h2);
+
+/**
+ * @brief Returns the index that the given string would have in the table, if it is a key.
+ *        THE CALLER MUST COMPARE THE STRING WITH THE KEY AT THAT INDEX, because every string gets some index.
+ *
+ * @param table The perfect hash table.
+ * @param str   The string to look for.
+ * @return int  The index, between 0 and table->keys - 1.
+ */
+int perfect_hash_index(const perfect_hash_table *table, char *str);
+
+#endif
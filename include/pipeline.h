@@ -0,0 +1,78 @@
+#ifndef __PIPELINE_H__
+#define __PIPELINE_H__
+
+#include "walk.h"
+#include "command.h"
+#include "source_file.h"
+#include "ring_buffer.h"
+#include "boolean.h"
+
+#include <pthread.h>
+
+/**
+ * This module reads a source in stages, on separate threads: the reader reads the lines (read_next_line()), and the
+ * parser parses and validates them (parse_line()). The walk that takes the commands (The first walk, or the single
+ * pass, which also encodes them) is the last stage. The stages are connected by single-producer / single-consumer
+ * ring buffers, so reading, parsing and encoding overlap.
+ * The messages of the parser are passed along with the commands, and are logged by the walk's thread - so they come
+ * in the same order as when the source is read directly.
+ */
+
+#define PIPELINE_LINES_CAPACITY    1024 /* How many lines may wait for the parser? */
+#define PIPELINE_COMMANDS_CAPACITY 1024 /* How many commands may wait for the walk? */
+
+typedef enum e_pipeline_status
+{
+    PIPELINE_NOT_ENOUGH_MEMORY,
+    PIPELINE_OK
+} pipeline_status;
+
+typedef struct s_pipeline_stats
+{
+    ring_buffer_stats lines;    /**< The counters of the ring from the reader to the parser. */
+    ring_buffer_stats commands; /**< The counters of the ring from the parser to the walk. */
+} pipeline_stats;
+
+typedef struct s_pipeline
+{
+    source_file *source;     /**< The source that the reader reads. */
+    ring_buffer lines;       /**< From the reader to the parser. */
+    ring_buffer commands;    /**< From the parser to the walk. */
+    pthread_t reader;
+    pthread_t parser;
+    boolean reader_started;
+    boolean parser_started;
+    boolean out_of_memory;   /**< Could the parser not keep a message? */
+    boolean done;            /**< Did the walk get the end of the source (Or a fatal error)? */
+    command_buffer buffer;   /**< The memory of the last command that the walk got. */
+} pipeline;
+
+/**
+ * @brief Starts reading the given source - starts the reader and the parser.
+ *
+ * @param pipeline_p The pipeline. SHOULD BE STOPPED BY pipeline_stop() - unless it could not be started.
+ * @param source     The source. It is read from it's start; Nobody else may use it until the pipeline is stopped.
+ * @return pipeline_status PIPELINE_NOT_ENOUGH_MEMORY or PIPELINE_OK.
+ */
+pipeline_status pipeline_start(pipeline *pipeline_p, source_file *source);
+
+/**
+ * @brief Returns the next command, parsed and validated - like get_next_command() does. Logs the messages of the
+ *        parser that came before it.
+ *
+ * @param pipeline_p  The pipeline.
+ * @param cmd         A pointer to where to insert the command into. Valid until the next call.
+ * @param line_number A pointer to where to put the line of the command.
+ * @return walk_status - WALK_NOT_ENOUGH_MEMORY or WALK_PROBLEM_WITH_CODE or WALK_EOF or WALK_OK. If the returned value is not WALK_OK, then DON'T use cmd. It is invalid.
+ */
+walk_status pipeline_next_command(pipeline *pipeline_p, command *cmd, int *line_number);
+
+/**
+ * @brief Stops the pipeline (Even if the source was not read to it's end), and frees it.
+ *
+ * @param pipeline_p The pipeline.
+ * @param stats_p    A pointer to where to put the counters of the stages. May be NULL.
+ */
+void pipeline_stop(pipeline *pipeline_p, pipeline_stats *stats_p);
+
+#endif
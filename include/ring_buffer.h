@@ -0,0 +1,98 @@
+#ifndef __RING_BUFFER_H__
+#define __RING_BUFFER_H__
+
+#include "boolean.h"
+
+#include <stddef.h>
+
+/**
+ * This module implements a bounded single-producer / single-consumer ring buffer of fixed size items. Exactly one
+ * thread pushes and exactly one thread pops; They never take a lock - every index is written by one side only, and is
+ * published to the other side with release / acquire atomics. A side that has to wait (The ring is full, or empty)
+ * spins for a while, and then yields the processor.
+ */
+
+#define RING_BUFFER_CACHE_LINE_SIZE 64 /* The head and the tail are kept apart, so the sides do not share a line */
+
+typedef enum e_ring_buffer_status
+{
+    RING_BUFFER_NOT_ENOUGH_MEMORY,
+    RING_BUFFER_OK
+} ring_buffer_status;
+
+typedef struct s_ring_buffer_stats
+{
+    unsigned long items;           /**< How many items were pushed? */
+    unsigned long max_depth;       /**< The most items that were in the ring at once. */
+    unsigned long producer_stalls; /**< How many times did the producer wait, because the ring was full? */
+    unsigned long consumer_stalls; /**< How many times did the consumer wait, because the ring was empty? */
+} ring_buffer_stats;
+
+typedef struct s_ring_buffer
+{
+    unsigned char *items;   /**< The items. */
+    size_t item_size;       /**< The size of an item, in bytes. */
+    unsigned long capacity; /**< How many items can the ring hold? A power of 2. */
+    int closed;             /**< Was the ring closed? Then no more items are pushed. */
+
+    char head_padding[RING_BUFFER_CACHE_LINE_SIZE];
+    unsigned long head;     /**< How many items were popped? Written only by the consumer. */
+    unsigned long consumer_stalls;
+
+    char tail_padding[RING_BUFFER_CACHE_LINE_SIZE];
+    unsigned long tail;     /**< How many items were pushed? Written only by the producer. */
+    unsigned long max_depth;
+    unsigned long producer_stalls;
+} ring_buffer;
+
+/**
+ * @brief Initializes an empty ring.
+ *
+ * @param ring_p    The ring.
+ * @param item_size The size of an item, in bytes.
+ * @param capacity  How many items can the ring hold? MUST BE A POWER OF 2.
+ * @return ring_buffer_status RING_BUFFER_NOT_ENOUGH_MEMORY or RING_BUFFER_OK.
+ */
+ring_buffer_status ring_buffer_init(ring_buffer *ring_p, size_t item_size, unsigned long capacity);
+
+/**
+ * @brief Pushes a copy of the given item. Waits while the ring is full. Only the producer may call it.
+ *
+ * @param ring_p The ring.
+ * @param item   A pointer to the item.
+ * @return boolean False if the ring was closed (Then the item was not pushed), else true.
+ */
+boolean ring_buffer_push(ring_buffer *ring_p, void *item);
+
+/**
+ * @brief Pops the oldest item. Waits while the ring is empty, unless it was closed. Only the consumer may call it.
+ *
+ * @param ring_p The ring.
+ * @param item   A pointer to where to copy the item.
+ * @return boolean False if the ring is empty and closed (Then nothing was popped), else true.
+ */
+boolean ring_buffer_pop(ring_buffer *ring_p, void *item);
+
+/**
+ * @brief Closes the ring - no more items are pushed, and nobody waits for it anymore. May be called by both sides.
+ *
+ * @param ring_p The ring.
+ */
+void ring_buffer_close(ring_buffer *ring_p);
+
+/**
+ * @brief Returns the counters of the ring. Call it only when both sides are done.
+ *
+ * @param ring_p  The ring.
+ * @param stats_p A pointer to where to put the counters.
+ */
+void ring_buffer_get_stats(ring_buffer *ring_p, ring_buffer_stats *stats_p);
+
+/**
+ * @brief Frees the items of the ring. (The items are not touched - if they own memory, pop them first)
+ *
+ * @param ring_p The ring.
+ */
+void ring_buffer_free(ring_buffer *ring_p);
+
+#endif
@@ -2,9 +2,10 @@
 #define __SECOND_WALK_H__
 
 #include "walk.h"
-#include "linked_list.h"
+#include "arena.h"
+#include "ir.h"
 
-/* This module implements the second walk, which gets as an input a symbols table, and returns:
+/* This module implements the second walk, which gets as an input the IR and the symbols table of the first walk, and returns:
     1. Data image + DCF
     2. Code image + ICF
     3. For every symbol, fills the is_entry field.
@@ -14,14 +15,63 @@
 /**
  * @brief Does the second walk.
  * 
- * @param file_name       The name of the input file.
- * @param symbols_table_p A pointer to the given symbols table. For every extern symbol, st->instructions_using_me shuold be freed using linked_list_free, and it's items should be freed.
- * @param data_image      A pointer to where to put the address of the data image. SHOULD BE FREED AFTER USAGE, unless it is NULL.
+ * @param program         The IR that the first walk created.
+ * @param symbols_table_p A pointer to the given symbols table.
+ * @param first_icf       The ICF of the first walk. The code image is allocated at exactly it's size.
+ * @param first_dcf       The DCF of the first walk. The data image is allocated at exactly it's size (Without the runs).
+ * @param data_image_p    A pointer to where to put the data image - it's content and it's runs. It is allocated from the
+ *                        arena.
  * @param dcf_p           A pointer to where to store the dcf after the second walk.
- * @param code_image      A pointer to where to put the address of the code image. SHOULD BE FREED AFTER USAGE, unless it is NULL.
+ * @param code_image      A pointer to where to put the address of the code image. It is allocated from the arena.
  * @param icf_p           A pointer to where to store the icf after the second walk.
- * @return walk_status WALK_NOT_ENOUGH_MEMORY or WALK_IO_ERROR or WALK_PROBLEM_WITH_CODE or WALK_OK.
+ * @param arena_p         The compilation's arena. The images and the extern uses are allocated from it.
+ * @param threads         How many threads may encode the instructions? The instructions of a big IR are encoded in
+ *                        parallel; The result (And the order of the messages) is the same.
+ * @return walk_status WALK_NOT_ENOUGH_MEMORY or WALK_PROBLEM_WITH_CODE or WALK_OK.
  */
-walk_status second_walk(char* file_name, symbols_table *symbols_table_p, unsigned char **data_image, unsigned long *dcf_p, unsigned char **code_image, unsigned long *icf_p);
+walk_status second_walk(ir *program, symbols_table *symbols_table_p, unsigned long first_icf, unsigned long first_dcf, image *data_image_p, unsigned long *dcf_p, unsigned char **code_image, unsigned long *icf_p, arena *arena_p, int threads);
+
+/**
+ * @brief Handles an "entry" directive - marks the given label as entry. Logs if it cannot be marked.
+ * 
+ * @param label        The label to mark.
+ * @param st           The symbols table. MUST BE COMPLETE.
+ * @param line         On what line is the directive?
+ * @return walk_status WALK_PROBLEM_WITH_CODE or WALK_OK
+ */
+walk_status handle_entry_directive(char *label, symbols_table st, int line);
+
+/**
+ * @brief Handles the given "define" directive. ('db' or 'dh' or 'dw').
+ *  
+ * @param record       The "define" directive. MUST BE VALIDATED.
+ * @param data_image_p A pointer to the data image.
+ * @param dc_p         A pointer to the DC.
+ * @param arena_p      The arena that the data image is allocated from.
+ * @return walk_status WALK_NOT_ENOUGH_MEMORY or WALK_OK
+ */
+walk_status handle_define_directive(ir_record *record, image *data_image_p, unsigned long *dc_p, arena *arena_p);
+
+/**
+ * @brief Handles the given "asciz" directive.
+ *  
+ * @param record       The "asciz" directive. MUST BE VALIDATED.
+ * @param data_image_p A pointer to the data image.
+ * @param dc_p         A pointer to the DC.
+ * @param arena_p      The arena that the data image is allocated from.
+ * @return walk_status WALK_NOT_ENOUGH_MEMORY or WALK_OK
+ */
+walk_status handle_asciz_directive(ir_record *record, image *data_image_p, unsigned long *dc_p, arena *arena_p);
+
+/**
+ * @brief Handles the given "space" or "fill" directive - adds it's run to the data image, without expanding it.
+ *  
+ * @param record       The "space" or "fill" directive. MUST BE VALIDATED.
+ * @param data_image_p A pointer to the data image.
+ * @param dc_p         A pointer to the DC.
+ * @param arena_p      The arena that the data image is allocated from.
+ * @return walk_status WALK_NOT_ENOUGH_MEMORY or WALK_OK
+ */
+walk_status handle_run_directive(ir_record *record, image *data_image_p, unsigned long *dc_p, arena *arena_p);
 
 #endif
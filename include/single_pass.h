@@ -0,0 +1,32 @@
+#ifndef __SINGLE_PASS_H__
+#define __SINGLE_PASS_H__
+
+#include "walk.h"
+#include "arena.h"
+#include "source_file.h"
+#include "pipeline.h"
+
+/* This module implements the single pass - it does the work of both walks while reading the source only once.
+   Every instruction is encoded as soon as it is read; An instruction that uses a label which was not defined yet is
+   put on the label's fixup chain, and it's label field is patched when the label is defined (Or at EOF, for data
+   labels, whose addresses are known only after the code). The outputs and the logs are the same as of the two walks.
+*/
+
+/**
+ * @brief Does the single pass.
+ * 
+ * @param source          The source to compile.
+ * @param symbols_table_p A pointer to an empty symbols table, which will be filled.
+ * @param data_image_p    A pointer to where to put the data image - it's content and it's runs. It is allocated from the
+ *                        arena.
+ * @param dcf_p           A pointer to where to store the dcf.
+ * @param code_image      A pointer to where to put the address of the code image. It is allocated from the arena.
+ * @param icf_p           A pointer to where to store the icf.
+ * @param arena_p         The compilation's arena. Everything that the pass allocates comes from it.
+ * @param pipeline_p      A started pipeline of the source, to take the commands from - so the commands are encoded while
+ *                        the next lines are read and parsed; Or NULL to read the source here.
+ * @return walk_status WALK_NOT_ENOUGH_MEMORY or WALK_PROBLEM_WITH_CODE or WALK_OK.
+ */
+walk_status single_pass(source_file *source, symbols_table *symbols_table_p, image *data_image_p, unsigned long *dcf_p, unsigned char **code_image, unsigned long *icf_p, arena *arena_p, pipeline *pipeline_p);
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef __SOURCE_FILE_H__
+#define __SOURCE_FILE_H__
+
+#include "boolean.h"
+
+#include <stddef.h>
+
+/**
+ * This module is the input layer - it gives the lines of a source file. A regular file is mapped into memory;
+ * Anything that cannot be mapped (like a pipe) is read into a buffer instead.
+ * The lines are given as views into the content - they are not copied, and are NOT null terminated.
+ * The content is scanned for newlines a block at a time - a block is as many chars as there are bits in an unsigned
+ * long, and it's newlines become a bit mask (With AVX2 or SSE2 compares if the compiler targets them, else with a
+ * byte loop). Every line is then found by the lowest bit of the mask.
+ */
+
+typedef enum e_source_file_status
+{
+    SOURCE_FILE_IO_ERROR,
+    SOURCE_FILE_NOT_ENOUGH_MEMORY,
+    SOURCE_FILE_EOF,
+    SOURCE_FILE_OK
+} source_file_status;
+
+typedef struct s_source_file
+{
+    char *content;          /**< The content of the file. NULL if the file is empty. */
+    size_t size;            /**< The size of the content, in bytes. */
+    size_t position;        /**< Where does the next line start? */
+    boolean mapped;         /**< Is the content mapped (true), or read into a buffer (false)? */
+
+    /* The newlines are found a block at a time (With SIMD, where it is available) */
+    size_t block_start;     /**< Where does the current block start? */
+    size_t scanned;         /**< Where does the next block start? */
+    unsigned long newlines; /**< A bit for every '\n' of the current block that was not given yet (Bit 0 is the first char). */
+} source_file;
+
+typedef struct s_line_view
+{
+    char *start;   /**< A pointer to the first char of the line, inside of the content. */
+    size_t length; /**< The length of the line, not including the '\n'. */
+} line_view;
+
+/**
+ * @brief Opens the given source file, and maps (or reads) it's content.
+ *
+ * @param file_name The name of the file.
+ * @param source    A pointer to where to put the opened file. SHOULD BE CLOSED BY source_file_close().
+ * @return source_file_status SOURCE_FILE_IO_ERROR or SOURCE_FILE_NOT_ENOUGH_MEMORY or SOURCE_FILE_OK.
+ */
+source_file_status source_file_open(char *file_name, source_file *source);
+
+/**
+ * @brief Makes a source file of the given buffer. The buffer is not copied - it must stay valid while the source is
+ *        used, and the source MUST NOT be closed.
+ *
+ * @param content The content. It is only read.
+ * @param size    The size of the content, in bytes.
+ * @param source  A pointer to where to put the source file.
+ */
+void source_file_from_buffer(char *content, size_t size, source_file *source);
+
+/**
+ * @brief Gives the next line of the given source file.
+ *
+ * @param source The source file.
+ * @param line   A pointer to where to put the view of the line.
+ * @return source_file_status SOURCE_FILE_EOF (Then line is untouched) or SOURCE_FILE_OK.
+ */
+source_file_status source_file_next_line(source_file *source, line_view *line);
+
+/**
+ * @brief Goes back to the first line of the given source file.
+ *
+ * @param source The source file.
+ */
+void source_file_rewind(source_file *source);
+
+/**
+ * @brief Releases the content of the given source file. The views that it gave become invalid.
+ *
+ * @param source The source file.
+ */
+void source_file_close(source_file *source);
+
+#endif
@@ -7,17 +7,16 @@
 
 #include "boolean.h"
 
-/**
- * @brief Moves the given string to the first non-whitespace char
- * @param ptr A pointer to the string.
- */
-void skip_whitespaces(char** ptr);
+#include <stddef.h>
 
 /**
- * @brief Checks if the given string is really a number.
- * @param str The string to check.
+ * @brief Checks if the given string is really a number (Decimal, with an optional sign), and converts it - in a single
+ *        pass. A number that does not fit in a long is saturated to LONG_MIN or LONG_MAX, like strtol() does.
+ * @param str      The string to check.
+ * @param value_p  A pointer to where to put the number. Undefined if it is not a number.
+ * @param length_p A pointer to where to put the length of the string (Even if it is not a number).
  * @return true if it is a number; else - false.
  */
-boolean is_number(char* str);
+boolean parse_number(char* str, long *value_p, size_t *length_p);
 
 #endif
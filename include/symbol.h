@@ -2,7 +2,6 @@
 #define __SYMBOL_H__
 
 #include "boolean.h"
-#include "linked_list.h"
 
 /* This module defines the symbol sturct, with represents a single symbol in the symbols table */
 
@@ -15,13 +14,22 @@ typedef enum e_symbol_type
     EXTERNAL
 } symbol_type;
 
+struct s_fixup; /* Defined by the single pass module */
+
 typedef struct s_symbol
 {
     char name[LABEL_MAX_LENGTH + 1];   /**< The name of the symbol. (+1 for the null terminator) */
     symbol_type type;                  /**< The type of the symbol */
     unsigned long value;               /**< The address of the symbol */
     boolean is_entry;                  /**< Is this symbol defined as entry? */
-    linked_list instructions_using_me; /**< What instructions are using me (Type is like value's type)? ONLY USED WHEN type=EXTERNAL */
+
+    /* ONLY USED WHEN type=EXTERNAL: */
+    unsigned long *instructions_using_me;        /**< The addresses of the instructions that use me, in ascending order. */
+    unsigned long instructions_using_me_count;    /**< How many instructions use me? */
+    unsigned long instructions_using_me_capacity; /**< The allocated length of instructions_using_me. */
+
+    /* ONLY USED BY THE SINGLE PASS, FOR LABELS THAT ARE USED BEFORE THEY ARE DEFINED: */
+    struct s_fixup *fixups;            /**< The instructions that wait for me to be defined, the last one first. */
 } symbol;
 
 #endif
\ No newline at end of file
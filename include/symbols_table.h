@@ -0,0 +1,75 @@
+#ifndef __SYMBOLS_TABLE_H__
+#define __SYMBOLS_TABLE_H__
+
+#include "symbol.h"
+#include "arena.h"
+
+/**
+ * This module implements the symbols table - a hash table (open addressing, linear probing) of symbols, keyed by
+ * their names. It also remembers the order in which the symbols were inserted, so the output files are always
+ * written in the same order. All of the table's memory comes from an arena, so there is nothing to free.
+ */
+
+typedef enum e_symbols_table_status
+{
+    SYMBOLS_TABLE_NOT_ENOUGH_MEMORY,
+    SYMBOLS_TABLE_OK
+} symbols_table_status;
+
+typedef struct s_symbols_table_data
+{
+    symbol **slots;                 /**< The hash slots. NULL means an empty slot. */
+    unsigned long slots_capacity;   /**< How many slots are there? Always a power of 2. */
+    symbol **symbols;               /**< All of the symbols, in insertion order. */
+    unsigned long symbols_capacity; /**< The allocated length of the symbols array. */
+    unsigned long length;           /**< How many symbols are in the table? */
+    arena *arena_p;                 /**< The arena that the table allocates from. */
+} symbols_table_data;
+
+typedef symbols_table_data *symbols_table;
+
+/**
+ * @brief Creates an empty symbols table.
+ *
+ * @param arena_p        The arena to allocate the table from. The table lives until this arena is reset.
+ * @return symbols_table The new symbols table, or NULL if there is not enough memory.
+ */
+symbols_table symbols_table_create(arena *arena_p);
+
+/**
+ * @brief Inserts the given symbol to the symbols table. The table does not copy the symbol, it only holds a pointer to it.
+ *        (So the symbol should be allocated from the table's arena as well)
+ *
+ * @param st       The symbols table.
+ * @param symbol_p The symbol to insert. A symbol with the same name MUST NOT BE IN THE TABLE ALREADY.
+ * @return symbols_table_status SYMBOLS_TABLE_NOT_ENOUGH_MEMORY or SYMBOLS_TABLE_OK.
+ */
+symbols_table_status symbols_table_insert(symbols_table st, symbol *symbol_p);
+
+/**
+ * @brief Finds a symbol in the symbols table, according to it's name.
+ *
+ * @param st       The symbols table to search in.
+ * @param name     The name of the symbol.
+ * @return symbol* A pointer to the found symbol; NULL if not found.
+ */
+symbol *symbols_table_find(symbols_table st, char *name);
+
+/**
+ * @brief Returns how many symbols are in the given symbols table.
+ *
+ * @param st                The symbols table.
+ * @return unsigned long    The number of symbols.
+ */
+unsigned long symbols_table_length(symbols_table st);
+
+/**
+ * @brief Returns the symbol that was inserted <index>th to the table. (Iterating on 0..length-1 gives insertion order)
+ *
+ * @param st       The symbols table.
+ * @param index    The index. Must be less than symbols_table_length().
+ * @return symbol* The symbol.
+ */
+symbol *symbols_table_get(symbols_table st, unsigned long index);
+
+#endif
@@ -2,7 +2,11 @@
 #define _TRANSLATOR_H
 
 #include "command.h"
+#include "ir.h"
 #include "walk.h"
+#include "symbol.h"
+#include "instructions_table.h"
+#include "boolean.h"
 
 /* This moudle translates a single assembly instruction to a 32 bit machine language instruction */
 
@@ -17,13 +21,73 @@ typedef enum e_translator_status
 
 /**
  * This method translates the given command into a machine code.
- * @param cmd                  The command to translate. cmd.command_type MUST be INSTRUCTION, and must be validated by the validator.
+ * @param record               The command to translate. It's type MUST be INSTRUCTION, and it must be validated by the validator.
  * @param st                   The symbols table.
  * @param ic                   The current instruction counter.
- * @param line                 On what line this instruction is?
  * @param m                    A pointer to a machine_instruction; Will be filled with the instruction.
  * @return translator_status   TRANSLATOR_OK or TRANSLATOR_LABEL_DOES_NOT_EXIST or TRANSLATOR_OVERFLOW
  */
-translator_status translator_translate(command cmd, symbols_table st, unsigned long ic, int line, machine_instruction* m);
+translator_status translator_translate(ir_record *record, symbols_table st, unsigned long ic, machine_instruction* m);
+
+/**
+ * This method translates the given command into a machine code, without resolving the label that it uses (If any).
+ * The label's field is left zeroed, so it can be put later by translator_put_label().
+ * @param record The command to translate. It's type MUST be INSTRUCTION, and it must be validated by the validator.
+ * @param m      A pointer to a machine_instruction; Will be filled with the instruction.
+ * @param type_p A pointer to where to put the type of the instruction.
+ * @return char* The label that the instruction uses (Points into the record's operands), or NULL if it uses no label.
+ */
+char *translator_translate_partial(ir_record *record, machine_instruction* m, instruction_type *type_p);
+
+/**
+ * This method decodes the given command into the given decoded instructions, at the given index - so it can be encoded
+ * later, without it's operands, by translator_encode().
+ * @param record         The command to decode. It's type MUST be INSTRUCTION, and it must be validated by the validator.
+ * @param instructions_p The decoded instructions. Their arrays must be long enough for the index.
+ * @param index          The index of the instruction.
+ * @return char*         The label that the instruction uses (Points into the record's operands), or NULL if it uses no label.
+ */
+char *translator_decode(ir_record *record, ir_instructions *instructions_p, unsigned long index);
+
+/**
+ * This method encodes the decoded instructions in [first, end) into the given code image - the i'th instruction at byte
+ * i * INSTRUCTION_SIZE. The labels' fields are left zeroed, so they can be put later by translator_put_label().
+ * @param instructions_p The decoded instructions.
+ * @param first          The index of the first instruction to encode.
+ * @param end            The index after the last instruction to encode.
+ * @param code_image     The code image. Must be long enough for the instructions.
+ */
+void translator_encode(ir_instructions *instructions_p, unsigned long first, unsigned long end, unsigned char *code_image);
+
+/**
+ * This method puts the given label's offset (For a conditional jump) or address (For a J instruction) in the given
+ * machine instruction, which was translated by translator_translate_partial().
+ * @param m                  The machine instruction to fill.
+ * @param type               The type of the instruction - I or J.
+ * @param label              The name of the label.
+ * @param symbol_p           The label's symbol, or NULL if it does not exist.
+ * @param ic                 The instruction counter of this instruction.
+ * @param line               On what line this instruction is?
+ * @param log                Should I log if the label cannot be put?
+ * @return translator_status TRANSLATOR_OK or TRANSLATOR_LABEL_DOES_NOT_EXIST or TRANSLATOR_OVERFLOW
+ */
+translator_status translator_put_label(machine_instruction* m, instruction_type type, char *label, symbol *symbol_p, unsigned long ic, int line, boolean log);
+
+/**
+ * This method stores the given machine instruction in the given code image, in little endian - whatever the byte order
+ * of the host is.
+ * @param code_image The code image.
+ * @param index      The index of the instruction in the code image, IN BYTES.
+ * @param m          The machine instruction.
+ */
+void translator_store(unsigned char *code_image, unsigned long index, machine_instruction m);
+
+/**
+ * This method loads a machine instruction that was stored by translator_store().
+ * @param code_image           The code image.
+ * @param index                The index of the instruction in the code image, IN BYTES.
+ * @return machine_instruction The machine instruction.
+ */
+machine_instruction translator_load(unsigned char *code_image, unsigned long index);
 
 #endif
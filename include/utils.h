@@ -2,8 +2,6 @@
 #define _UTILS_H
 
 #include "boolean.h"
-#include "walk.h"
-#include "symbol.h"
 
 /* This module is just a collection of useful functions */
 
@@ -16,22 +14,13 @@
 boolean is_in_range_2_complement(long num, int bits);
 
 /**
- * @brief Puts the given number in the given char array, in the given index.
+ * @brief Puts the given numbers in the given char array, one after the other.
  * 
- * @param arr   The char array
- * @param num   The number.
- * @param size  How many bytes of the number to put? (Little endian!)
- * @param index From what index to start?
+ * @param arr   The char array. Must be long enough for all of the numbers.
+ * @param nums  The numbers.
+ * @param count How many numbers?
+ * @param size  How many bytes of every number to put? 1, 2 or 4. (Little endian!)
  */
-void put_in_char_array(unsigned char *arr, long num, int size, unsigned long index);
-
-/**
- * @brief Finds a symbol in the symbols table, according to it's name.
- * 
- * @param name     The name of the symbol.
- * @param st       The symbols table to search in.
- * @return symbol* A pointer to the found symbol; NULL if not found.
- */
-symbol *find_symbol(char *name, symbols_table st);
+void put_numbers_in_char_array(unsigned char *arr, long *nums, unsigned long count, int size);
 
 #endif
\ No newline at end of file
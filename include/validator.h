@@ -14,11 +14,12 @@ typedef enum e_validator_status
 } validator_status;
 
 /**
- * Checks if the given command is valid.
- * @param cmd  The command to check.
- * @param line On what line this command is?
+ * Checks if the given command is valid, and resolves it's instruction (Or directive) - so the later stages do not have
+ * to look it up by name again.
+ * @param cmd_p A pointer to the command to check. It's inst and dir are set.
+ * @param line  On what line this command is?
  * @return VALIDATOR_INVALID or VALIDATOR_OK.
  */
-validator_status validator_validate(command cmd, int line);
+validator_status validator_validate(command *cmd_p, int line);
 
-#endif
\ No newline at end of file
+#endif
\ No newline at end of file
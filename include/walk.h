@@ -2,25 +2,25 @@
 #define __WALK_H__
 
 #include "command.h"
-#include "linked_list.h"
+#include "symbols_table.h"
+#include "source_file.h"
+#include "symbol.h"
+#include "arena.h"
 #include "boolean.h"
 
-#include <stdio.h>
-
 /* This module holds of the code that both walks use */
 
 #define IC_DEFAULT_VALUE 100
 #define DC_DEFAULT_VALUE 0
 
-#define LINE_MAX_LENGTH 80
-
 #define BYTE 1
 #define HALF 2
 #define WORD 4
 
 #define INSTRUCTION_SIZE 4 /* = 32 bits */
 
-typedef linked_list symbols_table;
+#define ADDRESS_BITS 32           /* The output files hold 32 bit addresses (See obb.h) */
+#define ADDRESS_MAX  0xFFFFFFFFUL /* The last address that they can hold */
 
 typedef enum walk_status_e
 {
@@ -28,9 +28,119 @@ typedef enum walk_status_e
     WALK_NOT_ENOUGH_MEMORY,
     WALK_PROBLEM_WITH_CODE,
     WALK_EOF,
+    WALK_EMPTY_LINE,
     WALK_OK
 } walk_status;
 
+/**
+ * A value that is repeated in the data - by ".space" or ".fill". It is not put in the content of the image, so a big
+ * reservation takes no memory; Only the object writers expand it.
+ */
+typedef struct s_data_run
+{
+    unsigned long address;     /**< The address of the first byte of the run, from the start of the data. */
+    unsigned long count;       /**< How many times is the value repeated? */
+    long value;                /**< The value - little endian, like the values of ".dh" and ".dw". */
+    int size;                  /**< The size of the value - BYTE or HALF or WORD. */
+    unsigned long runs_before; /**< How many bytes do the runs before this one take? */
+} data_run;
+
+typedef struct s_image
+{
+    unsigned char *content;      /**< The image itself, without the runs: the byte of an address that is not in a run
+                                      is at (address - the size of the runs before it). Allocated from the arena. */
+    unsigned long capacity;      /**< How many bytes are allocated for the content? */
+    data_run *runs;              /**< The runs of the image, in the order of their addresses. */
+    unsigned long runs_count;
+    unsigned long runs_capacity; /**< The allocated length of the runs array. */
+    unsigned long runs_size;     /**< How many bytes do all of the runs take? */
+} image;
+
+/**
+ * @brief Allocates an empty image.
+ *
+ * @param image_p  A pointer to the image to initialize.
+ * @param capacity How many bytes to allocate up front? The final size of the image, if it is already known - then it
+ *                 never has to grow; Or 0 if it is not known, for a small image that grows as needed.
+ * @param arena_p  The arena to allocate the image from.
+ * @return walk_status WALK_NOT_ENOUGH_MEMORY or WALK_OK.
+ */
+walk_status image_init(image *image_p, unsigned long capacity, arena *arena_p);
+
+/**
+ * @brief Makes sure that the given image can hold at least <size> bytes. It grows geometrically - the old content stays
+ *        in the arena until the end of the compilation.
+ *
+ * @param image_p A pointer to the image.
+ * @param size    How many bytes should the image hold?
+ * @param arena_p The arena that the image is allocated from.
+ * @return walk_status WALK_NOT_ENOUGH_MEMORY or WALK_OK.
+ */
+walk_status image_reserve(image *image_p, unsigned long size, arena *arena_p);
+
+/**
+ * @brief Makes sure that the given image can hold at least <count> runs. It grows geometrically, like image_reserve().
+ *
+ * @param image_p A pointer to the image.
+ * @param count   How many runs should the image hold?
+ * @param arena_p The arena that the image is allocated from.
+ * @return walk_status WALK_NOT_ENOUGH_MEMORY or WALK_OK.
+ */
+walk_status image_reserve_runs(image *image_p, unsigned long count, arena *arena_p);
+
+/**
+ * @brief Appends a run to the given image. It must come after all of the data that is already in the image.
+ *
+ * @param image_p A pointer to the image.
+ * @param address The address of the run.
+ * @param count   How many times is the value repeated? Must not be 0.
+ * @param value   The value.
+ * @param size    The size of the value - BYTE or HALF or WORD.
+ * @param arena_p The arena that the image is allocated from.
+ * @return walk_status WALK_NOT_ENOUGH_MEMORY or WALK_OK.
+ */
+walk_status image_add_run(image *image_p, unsigned long address, unsigned long count, long value, int size, arena *arena_p);
+
+/**
+ * @brief Records that the instruction at <ic> uses the given extern symbol. The uses are kept in a contiguous array,
+ *        which doubles when it is full.
+ *
+ * @param symbol_p     The extern symbol.
+ * @param ic           The address of the instruction.
+ * @param arena_p      The arena to allocate the array from.
+ * @return walk_status WALK_NOT_ENOUGH_MEMORY or WALK_OK.
+ */
+walk_status add_extern_use(symbol *symbol_p, unsigned long ic, arena *arena_p);
+
+/**
+ * @brief Updates the data symbols' values to be AFTER the code.
+ *
+ * @param st  The symbols table.
+ * @param icf The final instruction counter.
+ */
+void relocate_data_symbols(symbols_table st, unsigned long icf);
+
+/**
+ * @brief How many bytes does the run of the given command reserve?
+ *
+ * @param cmd The command. MUST BE VALIDATED.
+ * @return unsigned long The size of the run of a ".space" or ".fill" directive; 0 for any other command.
+ */
+unsigned long run_size(command cmd);
+
+/**
+ * @brief Checks that the given command does not take the program past ADDRESS_MAX. The data comes after the code, so
+ *        every address is at most pc + dc - 1 - and it only grows; So only the command that crosses ADDRESS_MAX is
+ *        logged.
+ *
+ * @param pc   The program counter, before the command.
+ * @param dc   The data counter, before the command.
+ * @param cmd  The command. MUST BE VALIDATED.
+ * @param line The line of the command.
+ * @return walk_status WALK_PROBLEM_WITH_CODE or WALK_OK.
+ */
+walk_status check_address_range(unsigned long pc, unsigned long dc, command cmd, int line);
+
 /**
  * @brief Updates pc and dc according to the given command.
  * 
@@ -41,22 +151,38 @@ typedef enum walk_status_e
 void next_counter(unsigned long *pc, unsigned long *dc, command cmd);
 
 /**
- * @brief Returns the next command from the given file, parsed and validated.
+ * @brief This method reads the next line from the source. Every line must be at most LINE_MAX_LENGTH chars.
+ *        The line is given as a view into the source; It is copied into <buf> only because the parser needs a null
+ *        terminated string.
+ * @param source The source to read from.
+ * @param buf    The buffer to write into. Must be size of at least LINE_MAX_LENGTH + 1.
+ * @return WALK_PROBLEM_WITH_CODE (The line is too long) or WALK_EOF or WALK_OK
+ */
+walk_status read_next_line(source_file *source, char *buf);
+
+/**
+ * @brief Parses (And validates) a line that was read by read_next_line().
  * 
- * @param f              The file to read from. Returns WALK_EOF when reaching EOF.
- * @param cmd            A pointer to where to insert the command into.
- * @param line           A pointer to what line is it. Will be automatically incremented. MUST BE 0 ON THE FIRST CALL!
- * @param validate       Should I validate this command as well?
- * @return walk_status - WALK_NOT_ENOUGH_MEMORY or WALK_PROBLEM_WITH_CODE or WALK_EOF or WALK_OK. If the returned value is not WALK_OK, then DON'T use cmd. It is invalid.
+ * @param buffer_p    The buffer, whose line was read into. The command points into it.
+ * @param read_status What read_next_line() returned for it - WALK_PROBLEM_WITH_CODE or WALK_OK.
+ * @param cmd         A pointer to where to insert the command into.
+ * @param line_number The number of the line.
+ * @param validate    Should I validate this command as well?
+ * @return walk_status - WALK_NOT_ENOUGH_MEMORY or WALK_PROBLEM_WITH_CODE or WALK_EMPTY_LINE or WALK_OK. If the returned value is not WALK_OK, then DON'T use cmd. It is invalid.
  */
-walk_status get_next_command(FILE* f, command* cmd, int* line_number, boolean validate);
+walk_status parse_line(command_buffer *buffer_p, walk_status read_status, command *cmd, int line_number, boolean validate);
 
 /**
- * @brief Frees the memory allocated in the symbols table by the both walks. 
- *        MSUT ONLY BE CALLED AFTER BOTH OF THE CALLS WERE DONE!
+ * @brief Returns the next command from the given source, parsed and validated.
  * 
- * @param st The symbols table.
+ * @param source         The source to read from. Returns WALK_EOF when reaching EOF.
+ * @param buffer_p       The buffer to read the line into. The command points into it, so it must live as long as the
+ *                       command is used.
+ * @param cmd            A pointer to where to insert the command into.
+ * @param line           A pointer to what line is it. Will be automatically incremented. MUST BE 0 ON THE FIRST CALL!
+ * @param validate       Should I validate this command as well?
+ * @return walk_status - WALK_NOT_ENOUGH_MEMORY or WALK_PROBLEM_WITH_CODE or WALK_EOF or WALK_OK. If the returned value is not WALK_OK, then DON'T use cmd. It is invalid.
  */
-void free_symbols_table(symbols_table st);
+walk_status get_next_command(source_file* source, command_buffer *buffer_p, command* cmd, int* line_number, boolean validate);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,161 @@
+#include "arena.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* Every allocation is aligned to the size of this union, so it can hold any type */
+typedef union u_arena_alignment
+{
+    long l;
+    double d;
+    void *p;
+} arena_alignment;
+
+#define ALIGN_UP(size) (((size) + sizeof(arena_alignment) - 1) / sizeof(arena_alignment) * sizeof(arena_alignment))
+
+#define BLOCK_HEADER_SIZE ALIGN_UP(sizeof(arena_block))
+#define BLOCK_DATA(block) ((char *)(block) + BLOCK_HEADER_SIZE)
+
+/* Allocations bigger than this get a block of their own, so they will not waste the rest of the current block */
+#define DEDICATED_BLOCK_THRESHOLD (ARENA_BLOCK_SIZE / 4)
+
+/**
+ * @brief Allocates a new block.
+ *
+ * @param capacity      How many bytes should the block hold?
+ * @return arena_block* The new block, or NULL if there is not enough memory.
+ */
+static arena_block *create_block(size_t capacity)
+{
+    arena_block *block = malloc(BLOCK_HEADER_SIZE + capacity);
+    if (!block)
+        return NULL;
+
+    block->next = NULL;
+    block->capacity = capacity;
+    block->used = 0;
+
+    return block;
+}
+
+void arena_init(arena *arena_p)
+{
+    arena_p->blocks = NULL;
+}
+
+void *arena_alloc(arena *arena_p, size_t size)
+{
+    arena_block *block = arena_p->blocks;
+
+    size = ALIGN_UP(size);
+
+    if (!block || block->capacity - block->used < size)
+    {
+        if (size > DEDICATED_BLOCK_THRESHOLD)
+        {
+            /* Put it after the first block, so the first block can still be used for the next allocations */
+            block = create_block(size);
+            if (!block)
+                return NULL;
+
+            if (arena_p->blocks)
+            {
+                block->next = arena_p->blocks->next;
+                arena_p->blocks->next = block;
+            }
+            else
+                arena_p->blocks = block;
+        }
+        else
+        {
+            block = create_block(ARENA_BLOCK_SIZE);
+            if (!block)
+                return NULL;
+
+            block->next = arena_p->blocks;
+            arena_p->blocks = block;
+        }
+    }
+
+    block->used += size;
+    return BLOCK_DATA(block) + block->used - size;
+}
+
+void *arena_realloc(arena *arena_p, void *ptr, size_t old_size, size_t new_size)
+{
+    arena_block *block = arena_p->blocks;
+    void *new_ptr;
+
+    if (!ptr)
+        return arena_alloc(arena_p, new_size);
+
+    old_size = ALIGN_UP(old_size);
+
+    /* Is it the last allocation of the first block? Then maybe it can just grow in place */
+    if (block && (char *)ptr + old_size == BLOCK_DATA(block) + block->used &&
+        block->capacity - (block->used - old_size) >= ALIGN_UP(new_size))
+    {
+        block->used = block->used - old_size + ALIGN_UP(new_size);
+        return ptr;
+    }
+
+    new_ptr = arena_alloc(arena_p, new_size);
+    if (!new_ptr)
+        return NULL;
+    memcpy(new_ptr, ptr, old_size < new_size ? old_size : new_size);
+
+    return new_ptr;
+}
+
+void arena_adopt(arena *arena_p, arena *other_p)
+{
+    arena_block *last = other_p->blocks;
+
+    if (!last)
+        return;
+    while (last->next)
+        last = last->next;
+
+    /* Put them after the first block, so the first block can still be used for the next allocations */
+    if (arena_p->blocks)
+    {
+        last->next = arena_p->blocks->next;
+        arena_p->blocks->next = other_p->blocks;
+    }
+    else
+        arena_p->blocks = other_p->blocks;
+
+    other_p->blocks = NULL;
+}
+
+void arena_reset(arena *arena_p)
+{
+    arena_block *block = arena_p->blocks, *kept = NULL;
+
+    while (block)
+    {
+        /* Holds the next block, because I won't be able to access it after I free the current block. */
+        arena_block *next = block->next;
+
+        if (!kept && block->capacity == ARENA_BLOCK_SIZE)
+            kept = block;
+        else
+            free(block);
+
+        block = next;
+    }
+
+    if (kept)
+    {
+        kept->next = NULL;
+        kept->used = 0;
+    }
+    arena_p->blocks = kept;
+}
+
+void arena_free(arena *arena_p)
+{
+    arena_reset(arena_p);
+    free(arena_p->blocks);
+    arena_p->blocks = NULL;
+}
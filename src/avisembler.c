@@ -0,0 +1,213 @@
+#include "avisembler.h"
+#include "first_walk.h"
+#include "second_walk.h"
+#include "single_pass.h"
+#include "symbols_table.h"
+#include "source_file.h"
+#include "logger.h"
+#include "walk.h"
+#include "ir.h"
+#include "pipeline.h"
+#include "diagnostics.h"
+
+#include <string.h>
+
+/**
+ * @brief Fills the entries and the externals of the result, from the symbols table.
+ *
+ * @param st       The symbols table.
+ * @param result_p The result.
+ * @param arena_p  The arena to allocate the tables from.
+ * @return walk_status WALK_NOT_ENOUGH_MEMORY or WALK_OK.
+ */
+static walk_status collect_symbols(symbols_table st, avisembler_result *result_p, arena *arena_p)
+{
+    unsigned long i, j, entries_count = 0, externals_count = 0;
+
+    for (i = 0; i < symbols_table_length(st); i++)
+    {
+        symbol *symbol_p = symbols_table_get(st, i);
+        if (symbol_p->is_entry)
+            entries_count++;
+        if (symbol_p->type == EXTERNAL)
+            externals_count += symbol_p->instructions_using_me_count;
+    }
+
+    if (entries_count > 0 && !(result_p->entries = arena_alloc(arena_p, sizeof(avisembler_symbol) * entries_count)))
+        return WALK_NOT_ENOUGH_MEMORY;
+    if (externals_count > 0 && !(result_p->externals = arena_alloc(arena_p, sizeof(avisembler_symbol) * externals_count)))
+        return WALK_NOT_ENOUGH_MEMORY;
+
+    for (i = 0; i < symbols_table_length(st); i++)
+    {
+        symbol *symbol_p = symbols_table_get(st, i);
+        if (symbol_p->is_entry)
+        {
+            result_p->entries[result_p->entries_count].name = symbol_p->name;
+            result_p->entries[result_p->entries_count++].address = symbol_p->value;
+        }
+        if (symbol_p->type == EXTERNAL)
+        {
+            for (j = 0; j < symbol_p->instructions_using_me_count; j++)
+            {
+                result_p->externals[result_p->externals_count].name = symbol_p->name;
+                result_p->externals[result_p->externals_count++].address = symbol_p->instructions_using_me[j];
+            }
+        }
+    }
+
+    return WALK_OK;
+}
+
+void avisembler_init(avisembler *assembler_p)
+{
+    assembler_p->single_pass = false;
+    assembler_p->threads = 1;
+    assembler_p->pipelined = false;
+    arena_init(&assembler_p->arena);
+    diagnostics_init(&assembler_p->diagnostics, &assembler_p->arena);
+}
+
+avisembler_status avisembler_assemble(avisembler *assembler_p, char *source, size_t size, avisembler_result *result_p)
+{
+    source_file source_view;
+    symbols_table st;
+    ir program;
+    walk_status status;
+    logger_sink *previous_sink_p;
+    pipeline source_pipeline, *pipeline_p = NULL;
+    arena *arena_p = &assembler_p->arena;
+    unsigned long first_icf = IC_DEFAULT_VALUE, first_dcf = DC_DEFAULT_VALUE; /* The counters of the first walk */
+    image data;
+
+    /* The previous result goes away */
+    arena_reset(arena_p);
+    memset(result_p, 0, sizeof(avisembler_result));
+    result_p->code_address = result_p->icf = IC_DEFAULT_VALUE;
+    diagnostics_init(&assembler_p->diagnostics, arena_p);
+
+    /* Everything that the walks log becomes a diagnostic */
+    previous_sink_p = diagnostics_redirect(&assembler_p->diagnostics);
+
+    source_file_from_buffer(source, size, &source_view);
+    ir_init(&program, arena_p);
+    st = symbols_table_create(arena_p);
+    memset(&assembler_p->pipeline_stats, 0, sizeof(pipeline_stats));
+    if (!st || (assembler_p->pipelined && pipeline_start(&source_pipeline, &source_view) != PIPELINE_OK))
+        status = WALK_NOT_ENOUGH_MEMORY;
+    else
+    {
+        if (assembler_p->pipelined)
+            pipeline_p = &source_pipeline;
+
+        if (assembler_p->single_pass)
+            status = single_pass(&source_view, &st, &data, &result_p->dcf, &result_p->code_image, &result_p->icf, arena_p, pipeline_p);
+        else
+            status = first_walk(&source_view, &st, &program, arena_p, assembler_p->threads, pipeline_p, &first_icf, &first_dcf);
+
+        /* The source is read - the stages are not needed anymore */
+        if (pipeline_p)
+            pipeline_stop(pipeline_p, &assembler_p->pipeline_stats);
+
+        if (!assembler_p->single_pass && status == WALK_OK) /* The second walk runs only on a valid source */
+            status = second_walk(&program, &st, first_icf, first_dcf, &data, &result_p->dcf, &result_p->code_image, &result_p->icf, arena_p, assembler_p->threads);
+    }
+
+    if (status == WALK_OK)
+    {
+        result_p->data_image = data.content;
+        result_p->data_runs = data.runs;
+        result_p->data_runs_count = data.runs_count;
+        status = collect_symbols(st, result_p, arena_p);
+    }
+
+    logger_redirect(previous_sink_p);
+    result_p->diagnostics = assembler_p->diagnostics.items;
+    result_p->diagnostics_count = assembler_p->diagnostics.count;
+
+    if (status != WALK_OK)
+    {
+        result_p->code_image = result_p->data_image = NULL;
+        result_p->icf = result_p->code_address;
+        result_p->dcf = 0;
+        result_p->data_runs = NULL;
+        result_p->data_runs_count = 0;
+    }
+
+    if (status == WALK_NOT_ENOUGH_MEMORY || assembler_p->diagnostics.out_of_memory)
+        return AVISEMBLER_NOT_ENOUGH_MEMORY;
+    return status == WALK_OK ? AVISEMBLER_OK : AVISEMBLER_PROBLEM_WITH_CODE;
+}
+
+/**
+ * @brief Puts the bytes of the given run, from the given position in it.
+ *
+ * @param run_p    The run.
+ * @param position The position of the first byte, from the start of the run.
+ * @param length   How many bytes to put?
+ * @param out      Where to put them.
+ */
+static void expand_run(data_run *run_p, unsigned long position, unsigned long length, unsigned char *out)
+{
+    unsigned long i;
+
+    if (run_p->size == BYTE)
+    {
+        memset(out, (unsigned char) (run_p->value & 0xFF), length);
+        return;
+    }
+
+    /* Little endian - the byte at a position is of the (position % size)th byte of the value */
+    for (i = 0; i < length; i++)
+        out[i] = (unsigned char) (((unsigned long) run_p->value >> (8 * ((position + i) % run_p->size))) & 0xFF);
+}
+
+void avisembler_read_data(avisembler_result *result_p, unsigned long offset, unsigned long length, unsigned char *out)
+{
+    data_run *runs = result_p->data_runs;
+    unsigned long low = 0, high = result_p->data_runs_count, runs_before, chunk;
+
+    /* Find the first run that ends after the offset */
+    while (low < high)
+    {
+        unsigned long middle = low + (high - low) / 2;
+        if (runs[middle].address + runs[middle].count * runs[middle].size <= offset)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    runs_before = low > 0 ? runs[low - 1].runs_before + runs[low - 1].count * runs[low - 1].size : 0;
+
+    while (length > 0)
+    {
+        if (low < result_p->data_runs_count && offset >= runs[low].address) /* In a run */
+        {
+            unsigned long size = runs[low].count * runs[low].size, position = offset - runs[low].address;
+
+            chunk = size - position < length ? size - position : length;
+            expand_run(&runs[low], position, chunk, out);
+            if (position + chunk == size) /* The run is done */
+            {
+                runs_before += size;
+                low++;
+            }
+        }
+        else /* In the content, until the next run */
+        {
+            chunk = length;
+            if (low < result_p->data_runs_count && runs[low].address - offset < chunk)
+                chunk = runs[low].address - offset;
+            memcpy(out, result_p->data_image + offset - runs_before, chunk);
+        }
+
+        offset += chunk;
+        length -= chunk;
+        out += chunk;
+    }
+}
+
+void avisembler_free(avisembler *assembler_p)
+{
+    arena_free(&assembler_p->arena);
+    diagnostics_init(&assembler_p->diagnostics, &assembler_p->arena);
+}
@@ -1,18 +1,23 @@
 #include "command.h"
 
-#include <stdlib.h>
+#include <string.h>
 
 boolean command_has_label(command cmd)
 {
     return cmd.label[0] != '\0';
 }
 
-void free_command(command cmd) 
+void command_link(command *cmd_p, command_buffer *buffer_p)
 {
+    char *str = buffer_p->line;
     int i;
 
-    if (cmd.command_name_allocated) free(cmd.command_name);
-    for (i = 0; i < cmd.number_of_operands_allocated; i++)
-        free(cmd.operands[i]);
-    if (cmd.operands_array_allocated) free(cmd.operands);
+    cmd_p->command_name = str;
+    cmd_p->operands = cmd_p->number_of_operands > 0 ? buffer_p->operands : NULL;
+    cmd_p->values = cmd_p->number_of_operands > 0 ? buffer_p->values : NULL;
+    for (i = 0; i < cmd_p->number_of_operands; i++)
+    {
+        str += strlen(str) + 1;
+        buffer_p->operands[i] = str;
+    }
 }
@@ -0,0 +1,68 @@
+#include "diagnostics.h"
+#include "logger.h"
+#include "arena.h"
+#include "boolean.h"
+
+#include <string.h>
+
+void diagnostics_init(diagnostics *diagnostics_p, arena *arena_p)
+{
+    diagnostics_p->items = NULL;
+    diagnostics_p->count = diagnostics_p->capacity = 0;
+    diagnostics_p->arena_p = arena_p;
+    diagnostics_p->out_of_memory = false;
+}
+
+void diagnostics_add(void *context, char *module, char *type, int line, char *message)
+{
+    diagnostics *diagnostics_p = context;
+    diagnostic *diagnostic_p;
+    size_t message_size = strlen(message) + 1;
+
+    if (diagnostics_p->count == diagnostics_p->capacity)
+    {
+        unsigned long new_capacity = diagnostics_p->capacity ? diagnostics_p->capacity * 2 : DIAGNOSTICS_MIN_CAPACITY;
+        diagnostic *new_items = arena_realloc(diagnostics_p->arena_p, diagnostics_p->items,
+                                              sizeof(diagnostic) * diagnostics_p->capacity, sizeof(diagnostic) * new_capacity);
+        if (!new_items)
+        {
+            diagnostics_p->out_of_memory = true;
+            return;
+        }
+        diagnostics_p->items = new_items;
+        diagnostics_p->capacity = new_capacity;
+    }
+
+    diagnostic_p = &diagnostics_p->items[diagnostics_p->count];
+    diagnostic_p->message = arena_alloc(diagnostics_p->arena_p, message_size);
+    if (!diagnostic_p->message)
+    {
+        diagnostics_p->out_of_memory = true;
+        return;
+    }
+    memcpy(diagnostic_p->message, message, message_size);
+    diagnostic_p->module = module;
+    diagnostic_p->type = type;
+    diagnostic_p->line = line;
+    diagnostics_p->count++;
+}
+
+logger_sink *diagnostics_redirect(diagnostics *diagnostics_p)
+{
+    diagnostics_p->sink.stream = NULL;
+    diagnostics_p->sink.handler = diagnostics_add;
+    diagnostics_p->sink.context = diagnostics_p;
+    return logger_redirect(&diagnostics_p->sink);
+}
+
+void diagnostics_replay(diagnostic *items, unsigned long count, unsigned long *next_p, int last_line, int line_offset)
+{
+    for (; *next_p < count && items[*next_p].line <= last_line; (*next_p)++)
+    {
+        diagnostic *diagnostic_p = &items[*next_p];
+        if (diagnostic_p->module)
+            logger_log(diagnostic_p->module, diagnostic_p->type, line_offset + diagnostic_p->line, "%s", diagnostic_p->message);
+        else
+            logger_print("%s", diagnostic_p->message);
+    }
+}
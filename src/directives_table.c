@@ -1,34 +1,33 @@
 #include "directives_table.h"
+#include "perfect_hash.h"
 #include <string.h>
 
-#define LENGTH_OF_ARRAY(arr) (sizeof(arr) / sizeof((arr)[0]))
-
 static operand_type constant_byte_arr[] = {CONSTANT_BYTE};
 static operand_type constant_half_arr[] = {CONSTANT_HALF};
 static operand_type constant_word_arr[] = {CONSTANT_WORD};
 static operand_type string_arr[] = {STRING};
 static operand_type label_arr[] = {LABEL};
+static operand_type space_arr[] = {CONSTANT_WORD};                              /* The size */
+static operand_type fill_arr[] = {CONSTANT_WORD, CONSTANT_WORD, CONSTANT_WORD}; /* The count, the value and it's size */
+
+#define DIRECTIVE(id, name, number_of_operands, operands_types) {DIRECTIVE_##id, name, number_of_operands, operands_types},
 
 static directive directives_arr[] = {
-    {"db", DT_INFINITY, constant_byte_arr},
-    {"dh", DT_INFINITY, constant_half_arr},
-    {"dw", DT_INFINITY, constant_word_arr},
-    {"asciz", 1, string_arr},
-    {"entry", 1, label_arr},
-    {"extern", 1, label_arr}};
+#include "directives_list.h"
+};
+
+#undef DIRECTIVE
+
+/* The perfect hash is generated from directives_list.h, so it's keys are exactly the entries of directives_arr */
+#include "directives_hash.h"
 
 directives_table_status directives_table_get_directive(char *name, directive **dir)
 {
-    int i;
-
-    for (i = 0; i < LENGTH_OF_ARRAY(directives_arr); i++)
-    {
-        if (strcmp(directives_arr[i].name, name) == 0)
-        {
-            *dir = &directives_arr[i];
-            return DT_OK;
-        }
-    }
-
-    return DT_DIRECTIVE_DOES_NOT_EXIST;
-}
\ No newline at end of file
+    int index = perfect_hash_index(&directives_hash, name);
+
+    if (strcmp(directives_arr[index].name, name) != 0)
+        return DT_DIRECTIVE_DOES_NOT_EXIST;
+
+    *dir = &directives_arr[index];
+    return DT_OK;
+}
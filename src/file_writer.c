@@ -1,38 +1,85 @@
+#define _POSIX_C_SOURCE 200112L /* For write() and friends */
+
 #include "file_writer.h"
-#include "linked_list.h"
-#include "symbol.h"
-#include "walk.h"
+#include "avisembler.h"
+#include "boolean.h"
+#include "obb.h"
+#include "logger.h"
 
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
 
-#define SOURCE_EXT    "as"
-#define OBJECT_EXT    "ob"
-#define EXTERNALS_EXT "ext"
-#define ENTRIES_EXT   "ent"
+#define SOURCE_EXT        "as"
+#define OBJECT_EXT        "ob"
+#define BINARY_OBJECT_EXT "obb"
+#define EXTERNALS_EXT     "ext"
+#define ENTRIES_EXT       "ent"
 
 #define OBJECT_FILE_BYTES_PER_LINE 4
 
-/* The prologue of every writer function - opens a new file */
+#define ADDRESS_MIN_DIGITS 4
+
+#define OUTPUT_BUFFER_SIZE (256 * 1024)
+#define DATA_CHUNK_SIZE    (OBJECT_FILE_BYTES_PER_LINE * 1024) /* The runs of the data are expanded a chunk at a time */
+#define MAX_ROW_LENGTH     64 /* An address (At most 20 digits), and OBJECT_FILE_BYTES_PER_LINE bytes of " XX", and '\n' */
+
+#define NEW_FILE_MODE 0666 /* Like fopen(); The umask is applied */
+
+/* The hex representation of every byte, so a byte is formatted without printf() */
+#define HEX_ROW(high) high "0", high "1", high "2", high "3", high "4", high "5", high "6", high "7", \
+                      high "8", high "9", high "A", high "B", high "C", high "D", high "E", high "F"
+static const char hex_table[256][3] = {
+    HEX_ROW("0"), HEX_ROW("1"), HEX_ROW("2"), HEX_ROW("3"), HEX_ROW("4"), HEX_ROW("5"), HEX_ROW("6"), HEX_ROW("7"),
+    HEX_ROW("8"), HEX_ROW("9"), HEX_ROW("A"), HEX_ROW("B"), HEX_ROW("C"), HEX_ROW("D"), HEX_ROW("E"), HEX_ROW("F")
+};
+
+/* The output of a writer is formatted into this buffer, which is written to the file only when it is full */
+typedef struct s_output_buffer
+{
+    int fd;         /**< The file to write into. */
+    char *data;     /**< The buffer, of size OUTPUT_BUFFER_SIZE. */
+    size_t used;    /**< How many bytes of the buffer are used? */
+    boolean failed; /**< Did a write fail? Then nothing more is written. */
+} output_buffer;
+
+/* The prologue of every writer function - opens a new file, and allocates it's output buffer */
 #define FILE_WRITER_PROLOGUE(original_file_name, new_ext) { \
     new_file_name = change_extension(original_file_name, new_ext); \
     if (!new_file_name) \
         return FILE_WRITER_NOT_ENOUGH_MEMORY; \
-    file = fopen(new_file_name, "w"); \
-    if (!file) \
+    out.data = malloc(OUTPUT_BUFFER_SIZE); \
+    if (!out.data) \
     { \
-        printf("Error: Cannot open file \"%s\". Skipping.\n", new_file_name); \
+        free(new_file_name); \
+        return FILE_WRITER_NOT_ENOUGH_MEMORY; \
+    } \
+    out.fd = open(new_file_name, O_WRONLY | O_CREAT | O_TRUNC, NEW_FILE_MODE); \
+    if (out.fd < 0) \
+    { \
+        logger_print("Error: Cannot open file \"%s\". Skipping.\n", new_file_name); \
+        free(out.data); \
         free(new_file_name); \
         return FILE_WRITER_IO_ERROR; \
     } \
+    out.used = 0; \
+    out.failed = false; \
 }
 
-/* The epilogue of every writer function - closes the opened file, free's the allocated file name and returns OK. */
+/* The epilogue of every writer function - writes what is left in the buffer, logs if a write failed, closes the
+   opened file, free's the allocated file name and buffer, and returns. */
 #define FILE_WRITER_EPILOGUE() { \
+    flush_output_buffer(&out); \
+    if (out.failed) \
+        logger_print("Error: Cannot write file \"%s\".\n", new_file_name); \
     free(new_file_name); \
-    fclose(file); \
-    return FILE_WRITER_OK; \
+    free(out.data); \
+    close(out.fd); \
+    return out.failed ? FILE_WRITER_IO_ERROR : FILE_WRITER_OK; \
 }
 
 /**
@@ -63,78 +110,278 @@ char* change_extension(char* original_file_name, char* new_ext)
     return new_file_name;
 }
 
-file_writer_status write_externals_file(char* original_file_name, symbols_table st)
+/**
+ * @brief Writes everything in the given buffer to it's file, and empties it.
+ *
+ * @param out The buffer.
+ */
+static void flush_output_buffer(output_buffer *out)
 {
-    int i, j;
-    char* new_file_name;
-    FILE* file;
+    size_t written = 0;
 
-    FILE_WRITER_PROLOGUE(original_file_name, EXTERNALS_EXT)
+    while (!out->failed && written < out->used)
+    {
+        ssize_t count = write(out->fd, out->data + written, out->used - written);
+        if (count >= 0)
+            written += (size_t) count;
+        else if (errno != EINTR)
+            out->failed = true;
+    }
 
-    for (i = 0; i < linked_list_length(st); i++)
+    out->used = 0;
+}
+
+/**
+ * @brief Makes sure that there is room for <length> more bytes in the given buffer.
+ *
+ * @param out    The buffer.
+ * @param length How many bytes? At most OUTPUT_BUFFER_SIZE.
+ */
+static void reserve_output_buffer(output_buffer *out, size_t length)
+{
+    if (out->used + length > OUTPUT_BUFFER_SIZE)
+        flush_output_buffer(out);
+}
+
+/**
+ * @brief Puts the given bytes in the given buffer.
+ *
+ * @param out    The buffer.
+ * @param bytes  The bytes.
+ * @param length How many bytes?
+ */
+static void put_bytes(output_buffer *out, void *bytes, size_t length)
+{
+    char *p = bytes;
+
+    while (length > 0)
     {
-        symbol* symbol_p = linked_list_get(st, i);
-        if (symbol_p->type == EXTERNAL)
-        {
-            for (j = 0; j < linked_list_length(symbol_p->instructions_using_me); j++)
-            {
-                fprintf(file, "%s %04lu\n", symbol_p->name, *((unsigned long*) linked_list_get(symbol_p->instructions_using_me, j)));
-            }
-        }
+        size_t chunk;
+
+        reserve_output_buffer(out, 1);
+        chunk = OUTPUT_BUFFER_SIZE - out->used;
+        if (chunk > length)
+            chunk = length;
+
+        memcpy(out->data + out->used, p, chunk);
+        out->used += chunk;
+        p += chunk;
+        length -= chunk;
     }
+}
 
-    FILE_WRITER_EPILOGUE()
+/**
+ * @brief Puts the given string in the given buffer.
+ *
+ * @param out The buffer.
+ * @param str The string.
+ */
+static void put_string(output_buffer *out, char *str)
+{
+    put_bytes(out, str, strlen(str));
 }
 
-file_writer_status write_entries_file(char* original_file_name, symbols_table st)
+/**
+ * @brief Puts the given number in decimal in the given buffer, like printf("%0<min_digits>lu") does.
+ *        There must be room for it (MAX_ROW_LENGTH is enough).
+ *
+ * @param out        The buffer.
+ * @param number     The number.
+ * @param min_digits The number is padded with zeros to at least this many digits.
+ */
+static void put_number(output_buffer *out, unsigned long number, int min_digits)
 {
-    int i;
-    char* new_file_name;
-    FILE* file;
+    char digits[24]; /* Enough for a 64 bit number */
+    int count = 0;
 
-    FILE_WRITER_PROLOGUE(original_file_name, ENTRIES_EXT)
+    do
+    {
+        digits[count++] = (char) ('0' + number % 10);
+        number /= 10;
+    } while (number > 0);
+
+    while (count < min_digits)
+        digits[count++] = '0';
+
+    while (count > 0)
+        out->data[out->used++] = digits[--count];
+}
 
-    for (i = 0; i < linked_list_length(st); i++)
+/**
+ * @brief Puts the given image in the given buffer, OBJECT_FILE_BYTES_PER_LINE bytes in a row. Every row starts with
+ *        the address of it's first byte; Only full rows end with '\n'.
+ *
+ * @param out           The buffer.
+ * @param image         The image.
+ * @param length        The length of the image.
+ * @param first_address The address of the first byte of the image.
+ */
+static void put_image(output_buffer *out, unsigned char *image, unsigned long length, unsigned long first_address)
+{
+    unsigned long i, j, row_end;
+
+    for (i = 0; i < length; i += OBJECT_FILE_BYTES_PER_LINE)
     {
-        symbol* symbol_p = linked_list_get(st, i);
-        if (symbol_p->is_entry)
+        char *p;
+
+        reserve_output_buffer(out, MAX_ROW_LENGTH);
+        put_number(out, first_address + i, ADDRESS_MIN_DIGITS); /* The adderss is printed only with the first in the row */
+
+        row_end = i + OBJECT_FILE_BYTES_PER_LINE;
+        if (row_end > length)
+            row_end = length;
+
+        p = out->data + out->used;
+        for (j = i; j < row_end; j++)
         {
-            fprintf(file, "%s %04lu\n", symbol_p->name, symbol_p->value);
+            const char *hex = hex_table[image[j]];
+            *p++ = ' ';
+            *p++ = hex[0];
+            *p++ = hex[1];
         }
+        if (row_end - i == OBJECT_FILE_BYTES_PER_LINE) /* This row is full */
+            *p++ = '\n';
+        out->used = (size_t) (p - out->data);
+    }
+}
+
+/**
+ * @brief Puts the data image of the given result in the given buffer - in hex rows, like put_image(), or as it is. The
+ *        runs are expanded a chunk at a time, so the whole data is never in memory.
+ *
+ * @param out      The buffer.
+ * @param result_p The result.
+ * @param as_rows  Should the data be put in rows, like put_image()? Else - the bytes are put as they are.
+ */
+static void put_data_image(output_buffer *out, avisembler_result *result_p, boolean as_rows)
+{
+    unsigned char chunk[DATA_CHUNK_SIZE];
+    unsigned long offset, length;
+
+    for (offset = 0; offset < result_p->dcf; offset += length)
+    {
+        unsigned char *bytes = result_p->data_image + offset;
+
+        length = result_p->dcf - offset;
+        if (result_p->data_runs_count > 0) /* Else - the data image is the whole data */
+        {
+            if (length > DATA_CHUNK_SIZE)
+                length = DATA_CHUNK_SIZE;
+            avisembler_read_data(result_p, offset, length, chunk);
+            bytes = chunk;
+        }
+
+        if (as_rows)
+            put_image(out, bytes, length, result_p->icf + offset);
+        else
+            put_bytes(out, bytes, length);
     }
+}
+
+/**
+ * @brief Puts a row of a symbol and an address ("NAME 0100\n") in the given buffer.
+ *
+ * @param out     The buffer.
+ * @param name    The name of the symbol.
+ * @param address The address.
+ */
+static void put_symbol_row(output_buffer *out, char *name, unsigned long address)
+{
+    put_string(out, name);
+    reserve_output_buffer(out, MAX_ROW_LENGTH);
+    out->data[out->used++] = ' ';
+    put_number(out, address, ADDRESS_MIN_DIGITS);
+    out->data[out->used++] = '\n';
+}
+
+file_writer_status write_externals_file(char* original_file_name, avisembler_result *result_p)
+{
+    unsigned long i;
+    char* new_file_name;
+    output_buffer out;
+
+    FILE_WRITER_PROLOGUE(original_file_name, EXTERNALS_EXT)
+
+    for (i = 0; i < result_p->externals_count; i++)
+        put_symbol_row(&out, result_p->externals[i].name, result_p->externals[i].address);
 
     FILE_WRITER_EPILOGUE()
 }
 
-file_writer_status write_object_file(char* original_file_name, unsigned char *data_image, unsigned long dcf, unsigned char *code_image, unsigned long icf)
+file_writer_status write_entries_file(char* original_file_name, avisembler_result *result_p)
 {
     unsigned long i;
     char* new_file_name;
-    FILE* file;
+    output_buffer out;
+
+    FILE_WRITER_PROLOGUE(original_file_name, ENTRIES_EXT)
+
+    for (i = 0; i < result_p->entries_count; i++)
+        put_symbol_row(&out, result_p->entries[i].name, result_p->entries[i].address);
+
+    FILE_WRITER_EPILOGUE()
+}
+
+file_writer_status write_object_file(char* original_file_name, avisembler_result *result_p)
+{
+    char* new_file_name;
+    output_buffer out;
+    unsigned long code_size = result_p->icf - result_p->code_address;
 
     FILE_WRITER_PROLOGUE(original_file_name, OBJECT_EXT)
 
     /* Write ICF and DCF */
-    fprintf(file, "%lu %lu\n", icf - IC_DEFAULT_VALUE, dcf);
+    reserve_output_buffer(&out, MAX_ROW_LENGTH);
+    put_number(&out, code_size, 1);
+    out.data[out.used++] = ' ';
+    put_number(&out, result_p->dcf, 1);
+    out.data[out.used++] = '\n';
 
     /* Write code image */
-    for (i = 0; i < icf - IC_DEFAULT_VALUE; i++)
-    {
-        if ((i + 1) % OBJECT_FILE_BYTES_PER_LINE == 1) /* This is first */
-            fprintf(file, "%04lu", i + IC_DEFAULT_VALUE); /* Print the adderss only with the first in the row */
-        fprintf(file, " %-2.2X", code_image[i]);
-        if ((i + 1) % OBJECT_FILE_BYTES_PER_LINE == 0) /* This is last */
-            fprintf(file, "\n");
-    }
+    put_image(&out, result_p->code_image, code_size, result_p->code_address);
 
     /* Write data image */
-    for (i = 0; i < dcf; i++)
+    put_data_image(&out, result_p, true);
+
+    FILE_WRITER_EPILOGUE()
+}
+
+file_writer_status write_binary_object_file(char* original_file_name, avisembler_result *result_p)
+{
+    unsigned long i;
+    char* new_file_name;
+    output_buffer out;
+    obb_header header;
+    unsigned char encoded_header[OBB_HEADER_SIZE], encoded_row[OBB_SYMBOL_ROW_SIZE];
+    static unsigned char padding[OBB_ALIGNMENT];
+
+    FILE_WRITER_PROLOGUE(original_file_name, BINARY_OBJECT_EXT)
+
+    header.version = OBB_VERSION;
+    header.flags = OBB_FLAG_ENTRIES | OBB_FLAG_EXTERNALS;
+    header.code_address = result_p->code_address;
+    header.icf = result_p->icf;
+    header.dcf = result_p->dcf;
+    header.entries_count = result_p->entries_count;
+    header.externals_count = result_p->externals_count;
+
+    /* Write the header and the images */
+    obb_encode_header(&header, encoded_header);
+    put_bytes(&out, encoded_header, OBB_HEADER_SIZE);
+    put_bytes(&out, result_p->code_image, result_p->icf - result_p->code_address);
+    put_data_image(&out, result_p, false);
+    put_bytes(&out, padding, obb_padding_size(&header));
+
+    /* Write the entries table and the externals table - the same rows as the ".ent" and ".ext" files */
+    for (i = 0; i < result_p->entries_count; i++)
+    {
+        obb_encode_symbol_row(result_p->entries[i].name, result_p->entries[i].address, encoded_row);
+        put_bytes(&out, encoded_row, OBB_SYMBOL_ROW_SIZE);
+    }
+    for (i = 0; i < result_p->externals_count; i++)
     {
-        if ((i + 1) % OBJECT_FILE_BYTES_PER_LINE == 1) /* This is first */
-            fprintf(file, "%04lu", icf + i); /* Print the adderss only with the first in the row */
-        fprintf(file, " %-2.2X", data_image[i]);
-        if ((i + 1) % OBJECT_FILE_BYTES_PER_LINE == 0) /* This is last */
-            fprintf(file, "\n");
+        obb_encode_symbol_row(result_p->externals[i].name, result_p->externals[i].address, encoded_row);
+        put_bytes(&out, encoded_row, OBB_SYMBOL_ROW_SIZE);
     }
 
     FILE_WRITER_EPILOGUE()
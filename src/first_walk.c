@@ -1,18 +1,37 @@
+#define _POSIX_C_SOURCE 200112L /* For pthread */
+
 #include "first_walk.h"
 #include "logger.h"
 #include "symbol.h"
+#include "symbols_table.h"
 #include "boolean.h"
 #include "walk.h"
-#include "utils.h"
 #include "command.h"
+#include "arena.h"
+#include "ir.h"
+#include "pipeline.h"
+#include "diagnostics.h"
 
-#include <stdio.h>
-#include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
 
 #define FIRST_WALK "FirstWalk"
 #define PROBLEM_WITH_CODE "PromblemWithCode"
 
+#define MIN_CHUNK_SIZE (256 * 1024) /* A smaller source is not worth splitting */
+
+typedef struct s_chunk
+{
+    source_file source;                  /**< A view of the chunk's lines. */
+    arena arena;                         /**< What the chunk allocates. It is adopted by the compilation's arena. */
+    ir program;                          /**< The chunk's commands. The lines and the counters start from 0. */
+    diagnostics diagnostics;             /**< The messages that were logged while parsing the chunk. Their lines are
+                                              counted from the start of the chunk. */
+    int lines;                           /**< How many lines are in the chunk? */
+    unsigned long pc, dc;                /**< How much did the chunk add to the program counter and the data counter? */
+    walk_status status;                  /**< WALK_NOT_ENOUGH_MEMORY or WALK_PROBLEM_WITH_CODE or WALK_OK. */
+} chunk;
+
 /**
  * @brief Checks if the label declared by ".extern" definition in the given table should be put in the given symbols table.
  *        That symbol should not be put if:
@@ -22,7 +41,7 @@
  */
 static boolean should_put_extern_symbol(command cmd)
 {
-    return strcmp(cmd.command_name, "extern") == 0;
+    return cmd.type == DIRECTIVE && cmd.dir->id == DIRECTIVE_EXTERN;
 }
 
 /**
@@ -40,10 +59,10 @@ static boolean should_put_label_symbol(command cmd)
     if (!command_has_label(cmd))
         return false;
 
-    if (strcmp(cmd.command_name, "extern") == 0)
+    if (cmd.type == DIRECTIVE && cmd.dir->id == DIRECTIVE_EXTERN)
         return false;
 
-    if (strcmp(cmd.command_name, "entry") == 0)
+    if (cmd.type == DIRECTIVE && cmd.dir->id == DIRECTIVE_ENTRY)
         return false;
 
     return true;
@@ -55,17 +74,28 @@ static boolean should_put_label_symbol(command cmd)
  * @param cmd The command. MUST BE VALIDATED.
  * @param st  The symbols table to insert into.
  * @param line On what line is this command is?
+ * @param arena_p The arena to allocate the symbol from.
+ * @param symbol_pp A pointer to where to put the new symbol. Untouched if no symbol was put.
  * @return WALK_NOT_ENOUGH_MEMORY or WALK_PROBLEM_WITH_CODE or WALK_OK.
  */
-static walk_status put_extern_symbol(command cmd, symbols_table *symbols_table_p, int line)
+static walk_status put_extern_symbol(command cmd, symbols_table *symbols_table_p, int line, arena *arena_p, symbol **symbol_pp)
 {
     symbol *symbol_t;
-    int i;
 
     if (!should_put_extern_symbol(cmd))
         return WALK_OK; /* Just skip it */
 
-    symbol_t = malloc(sizeof(symbol));
+    symbol_t = symbols_table_find(*symbols_table_p, cmd.operands[0]);
+    if (symbol_t) /* This symbol already exist */
+    {
+        if (symbol_t->type == EXTERNAL)
+            return WALK_OK;
+
+        logger_log(FIRST_WALK, PROBLEM_WITH_CODE, line, "Label \"%s\" was already defined", symbol_t->name);
+        return WALK_PROBLEM_WITH_CODE; /* You cannot define it extern if it has already been defined.. */
+    }
+
+    symbol_t = arena_alloc(arena_p, sizeof(symbol));
     if (!symbol_t)
         return WALK_NOT_ENOUGH_MEMORY;
     memset(symbol_t, 0, sizeof(symbol));
@@ -73,27 +103,14 @@ static walk_status put_extern_symbol(command cmd, symbols_table *symbols_table_p
     symbol_t->is_entry = false;
     symbol_t->type = EXTERNAL;
     symbol_t->value = 0; /* Will be filled by the linker */
-    symbol_t->instructions_using_me = linked_list_create();
+    symbol_t->instructions_using_me = NULL; /* Will be filled during the second walk */
+    symbol_t->instructions_using_me_count = symbol_t->instructions_using_me_capacity = 0;
     strcpy(symbol_t->name, cmd.operands[0]);
 
-    for (i = 0; i < linked_list_length(*symbols_table_p); i++)
-    {
-        symbol* s = (symbol*) linked_list_get(*symbols_table_p, i);
-        if (strcmp(s->name, symbol_t->name) == 0) /* This symbol already exist */
-        {
-            if (s->type == EXTERNAL)
-                return WALK_OK;
-            else
-            {
-                logger_log(FIRST_WALK, PROBLEM_WITH_CODE, line, "Label \"%s\" was already defined", symbol_t->name);
-                return WALK_PROBLEM_WITH_CODE; /* You cannot define it extern if it has already been defined.. */
-            }
-        }
-    }
-
-    if (linked_list_append(symbols_table_p, symbol_t) == LINKED_LIST_NOT_ENOUGH_MEMORY)
+    if (symbols_table_insert(*symbols_table_p, symbol_t) == SYMBOLS_TABLE_NOT_ENOUGH_MEMORY)
         return WALK_NOT_ENOUGH_MEMORY;
 
+    *symbol_pp = symbol_t;
     return WALK_OK;
 }
 
@@ -105,16 +122,24 @@ static walk_status put_extern_symbol(command cmd, symbols_table *symbols_table_p
  * @param pc  Current program counter
  * @param dc  Current data counter
  * @param line On what line is this command is?
+ * @param arena_p The arena to allocate the symbol from.
+ * @param symbol_pp A pointer to where to put the new symbol. Untouched if no symbol was put.
  * @return WALK_NOT_ENOUGH_MEMORY or WALK_PROBLEM_WITH_CODE or WALK_OK.
  */
-static walk_status put_label_symbol(command cmd, symbols_table *symbols_table_p, unsigned long pc, unsigned long dc, int line)
+static walk_status put_label_symbol(command cmd, symbols_table *symbols_table_p, unsigned long pc, unsigned long dc, int line, arena *arena_p, symbol **symbol_pp)
 {
     symbol *symbol_t;
 
     if (!should_put_label_symbol(cmd))
         return WALK_OK; /* Just skip it */
 
-    symbol_t = malloc(sizeof(symbol));
+    if (symbols_table_find(*symbols_table_p, cmd.label) != NULL)
+    {
+        logger_log(FIRST_WALK, PROBLEM_WITH_CODE, line, "Label \"%s\" was already defined", cmd.label);
+        return WALK_PROBLEM_WITH_CODE;
+    }
+
+    symbol_t = arena_alloc(arena_p, sizeof(symbol));
     if (!symbol_t)
         return WALK_NOT_ENOUGH_MEMORY;
     memset(symbol_t, 0, sizeof(symbol));
@@ -124,38 +149,21 @@ static walk_status put_label_symbol(command cmd, symbols_table *symbols_table_p,
     symbol_t->value = (cmd.type == INSTRUCTION) ? pc : dc;
     strcpy(symbol_t->name, cmd.label);
 
-    if (find_symbol(symbol_t->name, *symbols_table_p) != NULL)
-    {
-        logger_log(FIRST_WALK, PROBLEM_WITH_CODE, line, "Label \"%s\" was already defined", symbol_t->name);
-        free(symbol_t);
-        return WALK_PROBLEM_WITH_CODE;
-    }
-
-    if (linked_list_append(symbols_table_p, symbol_t) == LINKED_LIST_NOT_ENOUGH_MEMORY)
-    {
+    if (symbols_table_insert(*symbols_table_p, symbol_t) == SYMBOLS_TABLE_NOT_ENOUGH_MEMORY)
         return WALK_NOT_ENOUGH_MEMORY;
-    }
 
+    *symbol_pp = symbol_t;
     return WALK_OK;
 }
 
-/**
- * @brief Puts the symbol of the given command (If exist) in the symbols table.
- * 
- * @param cmd The command. MUST BE VALIDATED.
- * @param st  The symbols table to insert into.
- * @param pc  Current program counter
- * @param dc  Current data counter
- * @param line On what line is this command is?
- * @return WALK_NOT_ENOUGH_MEMORY or WALK_PROBLEM_WITH_CODE or WALK_OK.
- */
-static walk_status put_symbol(command cmd, symbols_table *symbols_table_p, unsigned long pc, unsigned long dc, int line)
+walk_status put_symbol(command cmd, symbols_table *symbols_table_p, unsigned long pc, unsigned long dc, int line, arena *arena_p, symbol **symbol_pp)
 {
     walk_status status;
 
-    if ((status = put_label_symbol(cmd, symbols_table_p, pc, dc, line)) != WALK_OK)
+    *symbol_pp = NULL;
+    if ((status = put_label_symbol(cmd, symbols_table_p, pc, dc, line, arena_p, symbol_pp)) != WALK_OK)
         return status;
-    if ((status = put_extern_symbol(cmd, symbols_table_p, line)) != WALK_OK)
+    if ((status = put_extern_symbol(cmd, symbols_table_p, line, arena_p, symbol_pp)) != WALK_OK)
         return status;
 
     return WALK_OK;
@@ -164,23 +172,33 @@ static walk_status put_symbol(command cmd, symbols_table *symbols_table_p, unsig
 /**
  * @brief Fills the symbols table with the symbols
  * 
- * @param f  The file to read from.
+ * @param source The source to read from.
+ * @param pipeline_p The pipeline to take the commands from, or NULL to read them from the source.
  * @param st The symbols table to write into.
+ * @param program The IR to write into.
+ * @param arena_p The arena to allocate the symbols from.
+ * @param icf_p A pointer to where to put the program counter after the last command.
+ * @param dcf_p A pointer to where to put the data counter after the last command.
  * @return walk_status - WALK_NOT_ENOUGH_MEMORY or WALK_PROBLEM_WITH_CODE or WALK_OK.
  */
-static walk_status fill_symbols_table(FILE *f, symbols_table *symbols_table_p)
+static walk_status fill_symbols_table(source_file *source, pipeline *pipeline_p, symbols_table *symbols_table_p, ir *program, arena *arena_p, unsigned long *icf_p, unsigned long *dcf_p)
 {
-    int line_number, i;
+    int line_number;
     unsigned long pc, dc;
     walk_status status, final_status = WALK_OK;
     command cmd;
+    command_buffer buffer;
+    symbol *new_symbol;
 
     line_number = 0;
     pc = IC_DEFAULT_VALUE, dc = DC_DEFAULT_VALUE;
 
     while (1)
     {   
-        status = get_next_command(f, &cmd, &line_number, true);
+        if (pipeline_p)
+            status = pipeline_next_command(pipeline_p, &cmd, &line_number);
+        else
+            status = get_next_command(source, &buffer, &cmd, &line_number, true);
         if (status == WALK_EOF)
             break;
         else if (status == WALK_PROBLEM_WITH_CODE)
@@ -191,44 +209,221 @@ static walk_status fill_symbols_table(FILE *f, symbols_table *symbols_table_p)
         else if (status == WALK_NOT_ENOUGH_MEMORY)
             return status;
 
-        status = put_symbol(cmd, symbols_table_p, pc, dc, line_number);
+        status = put_symbol(cmd, symbols_table_p, pc, dc, line_number, arena_p, &new_symbol);
         if (status == WALK_NOT_ENOUGH_MEMORY)
-        {
-            free_command(cmd);
             return status;
-        }
         else if (status == WALK_PROBLEM_WITH_CODE)
             final_status = status;
 
+        /* Save it, so the second walk will not have to parse it again */
+        if (ir_append(program, cmd, line_number, pc, dc) == IR_NOT_ENOUGH_MEMORY)
+            return WALK_NOT_ENOUGH_MEMORY;
+
+        if (check_address_range(pc, dc, cmd, line_number) == WALK_PROBLEM_WITH_CODE)
+            final_status = WALK_PROBLEM_WITH_CODE;
         next_counter(&pc, &dc, cmd);
-        free_command(cmd);
     }
 
     /* Update the data symbols' values to be AFTER the code */
-    for (i = 0; i < linked_list_length(*symbols_table_p); i++)
-    {
-        symbol* symbol_t = (symbol*) linked_list_get(*symbols_table_p, i);
-        if (symbol_t->type == DATA)
-            symbol_t->value += pc;
-    }
+    relocate_data_symbols(*symbols_table_p, pc);
 
+    *icf_p = pc;
+    *dcf_p = dc;
     return final_status;
 }
 
-walk_status first_walk(char *file_name, symbols_table *symbols_table_p)
+/**
+ * @brief Parses and validates the commands of a chunk. Does not touch the symbols table - the addresses are not known
+ *        yet, so the counters of the chunk start from 0. Runs on it's own thread.
+ *
+ * @param arg A pointer to the chunk.
+ * @return void* NULL.
+ */
+static void *parse_chunk(void *arg)
 {
-    FILE *file;
+    chunk *chunk_p = arg;
+    int line_number = 0;
     walk_status status;
+    command cmd;
+    command_buffer buffer;
+    logger_sink *previous_sink_p;
 
-    file = fopen(file_name, "r");
-    if (!file)
+    /* The messages are kept, so they can be logged again in the right order, and with the right line */
+    previous_sink_p = diagnostics_redirect(&chunk_p->diagnostics);
+
+    while (chunk_p->status != WALK_NOT_ENOUGH_MEMORY && !chunk_p->diagnostics.out_of_memory)
     {
-        printf("Error: Cannot open file \"%s\". Skipping.\n", file_name);
-        return WALK_IO_ERROR;
+        status = get_next_command(&chunk_p->source, &buffer, &cmd, &line_number, true);
+        if (status == WALK_EOF)
+            break;
+        else if (status == WALK_PROBLEM_WITH_CODE)
+        {
+            chunk_p->status = status;
+            continue;
+        }
+        else if (status == WALK_NOT_ENOUGH_MEMORY)
+        {
+            chunk_p->status = status;
+            break;
+        }
+
+        if (ir_append(&chunk_p->program, cmd, line_number, chunk_p->pc, chunk_p->dc) == IR_NOT_ENOUGH_MEMORY)
+            chunk_p->status = WALK_NOT_ENOUGH_MEMORY;
+
+        next_counter(&chunk_p->pc, &chunk_p->dc, cmd);
     }
+    chunk_p->lines = line_number - 1; /* The last one was the EOF */
+    if (chunk_p->diagnostics.out_of_memory)
+        chunk_p->status = WALK_NOT_ENOUGH_MEMORY;
+
+    logger_redirect(previous_sink_p);
+    return NULL;
+}
+
+/**
+ * @brief Splits the given source into newline-aligned chunks.
+ *
+ * @param source       The source.
+ * @param chunks       The chunks to fill.
+ * @param chunks_count How many chunks?
+ */
+static void split_source(source_file *source, chunk *chunks, int chunks_count)
+{
+    size_t start = 0, end;
+    int i;
+
+    for (i = 0; i < chunks_count; i++)
+    {
+        end = (i == chunks_count - 1) ? source->size : source->size / chunks_count * (i + 1);
+        if (end < start)
+            end = start;
+        if (end < source->size)
+        {
+            char *newline = memchr(source->content + end, '\n', source->size - end);
+            end = newline ? (size_t) (newline - source->content) + 1 : source->size;
+        }
+
+        source_file_from_buffer(source->content + start, end - start, &chunks[i].source);
+        arena_init(&chunks[i].arena);
+        ir_init(&chunks[i].program, &chunks[i].arena);
+        diagnostics_init(&chunks[i].diagnostics, &chunks[i].arena);
+        chunks[i].lines = 0;
+        chunks[i].pc = chunks[i].dc = 0;
+        chunks[i].status = WALK_OK;
+
+        start = end;
+    }
+}
+
+/**
+ * @brief Fills the symbols table with the symbols, like fill_symbols_table() - but the chunks of the source are parsed
+ *        and validated in parallel. Then, in the order of the chunks, the counters of every chunk are moved by the
+ *        counters of the chunks before it (A prefix sum), and the symbols are put; So the symbols, the problems and the
+ *        messages are the same as in a sequential walk.
+ * 
+ * @param source       The source to read from.
+ * @param st           The symbols table to write into.
+ * @param program      The IR to write into.
+ * @param arena_p      The arena to allocate the symbols from.
+ * @param chunks_count How many chunks (And threads)?
+ * @param icf_p        A pointer to where to put the program counter after the last command.
+ * @param dcf_p        A pointer to where to put the data counter after the last command.
+ * @return walk_status - WALK_NOT_ENOUGH_MEMORY or WALK_PROBLEM_WITH_CODE or WALK_OK.
+ */
+static walk_status fill_symbols_table_parallel(source_file *source, symbols_table *symbols_table_p, ir *program, arena *arena_p, int chunks_count, unsigned long *icf_p, unsigned long *dcf_p)
+{
+    chunk *chunks;
+    pthread_t *threads;
+    boolean *created;
+    int i, line_offset = 0;
+    unsigned long j, next_diagnostic, pc = IC_DEFAULT_VALUE, dc = DC_DEFAULT_VALUE;
+    walk_status status, final_status = WALK_OK;
+    command cmd;
+    symbol *new_symbol;
+
+    chunks = arena_alloc(arena_p, sizeof(chunk) * chunks_count);
+    threads = arena_alloc(arena_p, sizeof(pthread_t) * chunks_count);
+    created = arena_alloc(arena_p, sizeof(boolean) * chunks_count);
+    if (!chunks || !threads || !created)
+        return WALK_NOT_ENOUGH_MEMORY;
+
+    split_source(source, chunks, chunks_count);
+
+    /* The first chunk is parsed by this thread; If a thread cannot be created, it's chunk is parsed here too */
+    for (i = 1; i < chunks_count; i++)
+        created[i] = pthread_create(&threads[i], NULL, parse_chunk, &chunks[i]) == 0;
+    parse_chunk(&chunks[0]);
+    for (i = 1; i < chunks_count; i++)
+    {
+        if (created[i])
+            pthread_join(threads[i], NULL);
+        else
+            parse_chunk(&chunks[i]);
+    }
+
+    for (i = 0; i < chunks_count; i++)
+    {
+        chunk *chunk_p = &chunks[i];
+
+        if (final_status != WALK_NOT_ENOUGH_MEMORY)
+        {
+            next_diagnostic = 0;
+            for (j = 0; j < ir_length(&chunk_p->program) && final_status != WALK_NOT_ENOUGH_MEMORY; j++)
+            {
+                ir_record *record = ir_get(&chunk_p->program, j);
+
+                diagnostics_replay(chunk_p->diagnostics.items, chunk_p->diagnostics.count, &next_diagnostic, record->line, line_offset);
+                record->line += line_offset;
+                record->pc += pc;
+                record->dc += dc;
+
+                ir_record_command(record, &cmd);
+                status = put_symbol(cmd, symbols_table_p, record->pc, record->dc, record->line, arena_p, &new_symbol);
+                if (status != WALK_OK)
+                    final_status = status;
+                if (check_address_range(record->pc, record->dc, cmd, record->line) == WALK_PROBLEM_WITH_CODE && final_status != WALK_NOT_ENOUGH_MEMORY)
+                    final_status = WALK_PROBLEM_WITH_CODE;
+            }
+            diagnostics_replay(chunk_p->diagnostics.items, chunk_p->diagnostics.count, &next_diagnostic, chunk_p->lines, line_offset);
+
+            if (chunk_p->status != WALK_OK && final_status != WALK_NOT_ENOUGH_MEMORY)
+                final_status = chunk_p->status;
+            if (final_status != WALK_NOT_ENOUGH_MEMORY &&
+                ir_append_ir(program, &chunk_p->program) == IR_NOT_ENOUGH_MEMORY)
+                final_status = WALK_NOT_ENOUGH_MEMORY;
+
+            line_offset += chunk_p->lines;
+            pc += chunk_p->pc;
+            dc += chunk_p->dc;
+        }
+
+        /* The records point into the chunk's arena - so it lives as long as the compilation */
+        arena_adopt(arena_p, &chunk_p->arena);
+    }
+
+    if (final_status == WALK_NOT_ENOUGH_MEMORY)
+        return final_status;
+
+    /* Update the data symbols' values to be AFTER the code */
+    relocate_data_symbols(*symbols_table_p, pc);
+
+    *icf_p = pc;
+    *dcf_p = dc;
+    return final_status;
+}
+
+walk_status first_walk(source_file *source, symbols_table *symbols_table_p, ir *program, arena *arena_p, int threads, pipeline *pipeline_p, unsigned long *icf_p, unsigned long *dcf_p)
+{
+    int chunks_count = (int) (source->size / MIN_CHUNK_SIZE);
+
+    if (pipeline_p) /* The pipeline already reads the source */
+        return fill_symbols_table(source, pipeline_p, symbols_table_p, program, arena_p, icf_p, dcf_p);
 
-    status = fill_symbols_table(file, symbols_table_p);
+    if (chunks_count > threads)
+        chunks_count = threads;
 
-    fclose(file);
-    return status;
+    source_file_rewind(source);
+    if (chunks_count > 1)
+        return fill_symbols_table_parallel(source, symbols_table_p, program, arena_p, chunks_count, icf_p, dcf_p);
+    return fill_symbols_table(source, NULL, symbols_table_p, program, arena_p, icf_p, dcf_p);
 }
@@ -0,0 +1,289 @@
+#include "ir.h"
+#include "command.h"
+#include "translator.h"
+#include "walk.h"
+#include "arena.h"
+
+#include <string.h>
+
+#define INITIAL_RECORDS_CAPACITY 64
+#define INITIAL_INSTRUCTIONS_CAPACITY 64
+#define INITIAL_LABEL_USES_CAPACITY 16
+
+void ir_init(ir *ir_p, arena *arena_p)
+{
+    ir_p->records = NULL;
+    ir_p->length = ir_p->capacity = 0;
+    memset(&ir_p->instructions, 0, sizeof(ir_instructions));
+    ir_p->data_runs_count = ir_p->data_runs_size = 0;
+    ir_p->arena_p = arena_p;
+}
+
+/**
+ * @brief Reallocates an array of the IR to a new capacity.
+ *
+ * @param ir_p         A pointer to the IR.
+ * @param array_p      A pointer to the array. Untouched if there is not enough memory.
+ * @param element_size The size of an element.
+ * @param capacity     The current capacity.
+ * @param new_capacity The new capacity.
+ * @return ir_status IR_NOT_ENOUGH_MEMORY or IR_OK.
+ */
+static ir_status grow_array(ir *ir_p, void **array_p, size_t element_size, unsigned long capacity, unsigned long new_capacity)
+{
+    void *new_array = arena_realloc(ir_p->arena_p, *array_p, capacity * element_size, new_capacity * element_size);
+    if (!new_array)
+        return IR_NOT_ENOUGH_MEMORY;
+
+    *array_p = new_array;
+    return IR_OK;
+}
+
+/**
+ * @brief Makes sure that the fields arrays of the instructions of the given IR can hold at least <length> instructions.
+ *        They double.
+ *
+ * @param ir_p   A pointer to the IR.
+ * @param length How many instructions should they hold?
+ * @return ir_status IR_NOT_ENOUGH_MEMORY or IR_OK.
+ */
+static ir_status reserve_instructions(ir *ir_p, unsigned long length)
+{
+    ir_instructions *instructions_p = &ir_p->instructions;
+    unsigned long new_capacity = instructions_p->capacity ? instructions_p->capacity : INITIAL_INSTRUCTIONS_CAPACITY;
+    unsigned long capacity = instructions_p->capacity;
+
+    if (length <= capacity)
+        return IR_OK;
+
+    while (new_capacity < length)
+        new_capacity *= 2;
+
+    if (grow_array(ir_p, (void **) &instructions_p->ids, sizeof(unsigned char), capacity, new_capacity) == IR_NOT_ENOUGH_MEMORY ||
+        grow_array(ir_p, (void **) &instructions_p->rs, sizeof(unsigned char), capacity, new_capacity) == IR_NOT_ENOUGH_MEMORY ||
+        grow_array(ir_p, (void **) &instructions_p->rt, sizeof(unsigned char), capacity, new_capacity) == IR_NOT_ENOUGH_MEMORY ||
+        grow_array(ir_p, (void **) &instructions_p->rd, sizeof(unsigned char), capacity, new_capacity) == IR_NOT_ENOUGH_MEMORY ||
+        grow_array(ir_p, (void **) &instructions_p->immeds, sizeof(unsigned long), capacity, new_capacity) == IR_NOT_ENOUGH_MEMORY)
+        return IR_NOT_ENOUGH_MEMORY; /* The arrays that did grow are fine - the capacity is just not updated */
+
+    instructions_p->capacity = new_capacity;
+    return IR_OK;
+}
+
+/**
+ * @brief Makes sure that the label uses array of the given IR can hold at least <length> uses. It doubles.
+ *
+ * @param ir_p   A pointer to the IR.
+ * @param length How many uses should it hold?
+ * @return ir_status IR_NOT_ENOUGH_MEMORY or IR_OK.
+ */
+static ir_status reserve_label_uses(ir *ir_p, unsigned long length)
+{
+    ir_instructions *instructions_p = &ir_p->instructions;
+    unsigned long new_capacity = instructions_p->label_uses_capacity ? instructions_p->label_uses_capacity : INITIAL_LABEL_USES_CAPACITY;
+
+    if (length <= instructions_p->label_uses_capacity)
+        return IR_OK;
+
+    while (new_capacity < length)
+        new_capacity *= 2;
+
+    if (grow_array(ir_p, (void **) &instructions_p->label_uses, sizeof(ir_label_use), instructions_p->label_uses_capacity, new_capacity) == IR_NOT_ENOUGH_MEMORY)
+        return IR_NOT_ENOUGH_MEMORY;
+
+    instructions_p->label_uses_capacity = new_capacity;
+    return IR_OK;
+}
+
+/**
+ * @brief Decodes the given record, which is an instruction, to the instructions of the IR.
+ *
+ * @param ir_p   A pointer to the IR.
+ * @param record The record. It's strings must live as long as the IR.
+ * @return ir_status IR_NOT_ENOUGH_MEMORY or IR_OK.
+ */
+static ir_status append_instruction(ir *ir_p, ir_record *record)
+{
+    ir_instructions *instructions_p = &ir_p->instructions;
+    ir_label_use *use_p;
+    char *label;
+
+    if (reserve_instructions(ir_p, instructions_p->length + 1) == IR_NOT_ENOUGH_MEMORY ||
+        reserve_label_uses(ir_p, instructions_p->label_uses_count + 1) == IR_NOT_ENOUGH_MEMORY)
+        return IR_NOT_ENOUGH_MEMORY;
+
+    label = translator_decode(record, instructions_p, instructions_p->length);
+    if (label)
+    {
+        use_p = &instructions_p->label_uses[instructions_p->label_uses_count++];
+        use_p->index = instructions_p->length;
+        use_p->type = record->inst->type;
+        use_p->label = label;
+    }
+
+    instructions_p->length++;
+    return IR_OK;
+}
+
+/**
+ * @brief Makes sure that the records array of the given IR can hold at least <length> records. It doubles.
+ *
+ * @param ir_p   A pointer to the IR.
+ * @param length How many records should it hold?
+ * @return ir_status IR_NOT_ENOUGH_MEMORY or IR_OK.
+ */
+static ir_status reserve_records(ir *ir_p, unsigned long length)
+{
+    unsigned long new_capacity = ir_p->capacity ? ir_p->capacity : INITIAL_RECORDS_CAPACITY;
+    ir_record *new_records;
+
+    if (length <= ir_p->capacity)
+        return IR_OK;
+
+    while (new_capacity < length)
+        new_capacity *= 2;
+
+    new_records = arena_realloc(ir_p->arena_p, ir_p->records, ir_p->capacity * sizeof(ir_record), new_capacity * sizeof(ir_record));
+    if (!new_records)
+        return IR_NOT_ENOUGH_MEMORY;
+
+    ir_p->records = new_records;
+    ir_p->capacity = new_capacity;
+    return IR_OK;
+}
+
+ir_status ir_append(ir *ir_p, command cmd, int line, unsigned long pc, unsigned long dc)
+{
+    ir_record *record;
+    size_t strings_size;
+    char *strings;
+    int i;
+
+    if (reserve_records(ir_p, ir_p->length + 1) == IR_NOT_ENOUGH_MEMORY)
+        return IR_NOT_ENOUGH_MEMORY;
+
+    /* The values, the operands array and all of the strings are put in a single allocation */
+    strings_size = strlen(cmd.command_name) + 1 + strlen(cmd.label) + 1;
+    for (i = 0; i < cmd.number_of_operands; i++)
+        strings_size += strlen(cmd.operands[i]) + 1;
+
+    record = &ir_p->records[ir_p->length];
+    record->values = arena_alloc(ir_p->arena_p, cmd.number_of_operands * (sizeof(long) + sizeof(char *)) + strings_size);
+    if (!record->values)
+        return IR_NOT_ENOUGH_MEMORY;
+    if (cmd.number_of_operands > 0)
+        memcpy(record->values, cmd.values, cmd.number_of_operands * sizeof(long));
+    record->operands = (char **)(record->values + cmd.number_of_operands);
+    strings = (char *)(record->operands + cmd.number_of_operands);
+
+    for (i = 0; i < cmd.number_of_operands; i++)
+    {
+        strcpy(strings, cmd.operands[i]);
+        record->operands[i] = strings;
+        strings += strlen(strings) + 1;
+    }
+    strcpy(strings, cmd.command_name);
+    record->command_name = strings;
+    strings += strlen(strings) + 1;
+    strcpy(strings, cmd.label);
+    record->label = strings;
+
+    if (cmd.number_of_operands == 0)
+    {
+        record->operands = NULL;
+        record->values = NULL;
+    }
+
+    record->type = cmd.type;
+    record->inst = cmd.inst;
+    record->dir = cmd.dir;
+    record->number_of_operands = cmd.number_of_operands;
+    record->line = line;
+    record->pc = pc;
+    record->dc = dc;
+
+    if (record->type == INSTRUCTION && append_instruction(ir_p, record) == IR_NOT_ENOUGH_MEMORY)
+        return IR_NOT_ENOUGH_MEMORY;
+
+    if (run_size(cmd) > 0)
+    {
+        ir_p->data_runs_count++;
+        ir_p->data_runs_size += run_size(cmd);
+    }
+
+    ir_p->length++;
+    return IR_OK;
+}
+
+ir_status ir_append_ir(ir *ir_p, ir *other_p)
+{
+    ir_instructions *instructions_p = &ir_p->instructions, *other_instructions_p = &other_p->instructions;
+    unsigned long i, offset = instructions_p->length;
+
+    if (reserve_records(ir_p, ir_p->length + other_p->length) == IR_NOT_ENOUGH_MEMORY ||
+        reserve_instructions(ir_p, instructions_p->length + other_instructions_p->length) == IR_NOT_ENOUGH_MEMORY ||
+        reserve_label_uses(ir_p, instructions_p->label_uses_count + other_instructions_p->label_uses_count) == IR_NOT_ENOUGH_MEMORY)
+        return IR_NOT_ENOUGH_MEMORY;
+
+    if (other_p->length > 0)
+        memcpy(ir_p->records + ir_p->length, other_p->records, other_p->length * sizeof(ir_record));
+    ir_p->length += other_p->length;
+    ir_p->data_runs_count += other_p->data_runs_count;
+    ir_p->data_runs_size += other_p->data_runs_size;
+
+    if (other_instructions_p->length > 0)
+    {
+        memcpy(instructions_p->ids + offset, other_instructions_p->ids, other_instructions_p->length);
+        memcpy(instructions_p->rs + offset, other_instructions_p->rs, other_instructions_p->length);
+        memcpy(instructions_p->rt + offset, other_instructions_p->rt, other_instructions_p->length);
+        memcpy(instructions_p->rd + offset, other_instructions_p->rd, other_instructions_p->length);
+        memcpy(instructions_p->immeds + offset, other_instructions_p->immeds, other_instructions_p->length * sizeof(unsigned long));
+    }
+    instructions_p->length += other_instructions_p->length;
+
+    /* The uses point at the instructions of the other IR - they come after the instructions of this one now */
+    for (i = 0; i < other_instructions_p->label_uses_count; i++)
+    {
+        instructions_p->label_uses[instructions_p->label_uses_count] = other_instructions_p->label_uses[i];
+        instructions_p->label_uses[instructions_p->label_uses_count++].index += offset;
+    }
+
+    return IR_OK;
+}
+
+unsigned long ir_length(ir *ir_p)
+{
+    return ir_p->length;
+}
+
+ir_record *ir_get(ir *ir_p, unsigned long index)
+{
+    return &ir_p->records[index];
+}
+
+void ir_record_view(ir_record *record, command *cmd_p, int line, unsigned long pc, unsigned long dc)
+{
+    record->type = cmd_p->type;
+    record->command_name = cmd_p->command_name;
+    record->inst = cmd_p->inst;
+    record->dir = cmd_p->dir;
+    record->label = cmd_p->label;
+    record->operands = cmd_p->operands;
+    record->values = cmd_p->values;
+    record->number_of_operands = cmd_p->number_of_operands;
+    record->line = line;
+    record->pc = pc;
+    record->dc = dc;
+}
+
+void ir_record_command(ir_record *record, command *cmd_p)
+{
+    cmd_p->type = record->type;
+    cmd_p->command_name = record->command_name;
+    cmd_p->inst = record->inst;
+    cmd_p->dir = record->dir;
+    cmd_p->operands = record->operands;
+    cmd_p->values = record->values;
+    cmd_p->number_of_operands = record->number_of_operands;
+    strcpy(cmd_p->label, record->label);
+}
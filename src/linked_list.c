@@ -1,92 +1,85 @@
 #include "linked_list.h"
+#include "arena.h"
 
 #include <stdlib.h>
-#include <string.h>
+
+void linked_list_init(linked_list *l, arena *arena_p)
+{
+    l->head = NULL; /* When head=null, the list is empty */
+    l->tail = NULL;
+    l->length = 0;
+
+    l->arena_p = arena_p;
+    l->slab = NULL;
+    l->slab_left = 0;
+    l->slab_batch_size = 0;
+}
 
 /**
- * An important note:
- * In the outer interface for the function, I call "node*" - "linked_list",
- * in order to hide implementation details. But in the implementaion code, I just refer to that
- * like a simple node pointer.
+ * @brief Takes a free node from the slab of the given list. When the current batch is used up, a new batch is taken
+ *        from the arena - twice as big as the previous one, so short lists don't waste much, and long lists rarely
+ *        go to the arena.
+ *
+ * @param l      The linked list.
+ * @return node* The free node, or NULL if there is not enough memory.
  */
-
-linked_list linked_list_create()
+static node *take_node(linked_list *l)
 {
-    return (node *)NULL; /* When head=null, the list is empty */
+    if (l->slab_left == 0)
+    {
+        int batch_size = l->slab_batch_size * 2;
+        if (batch_size < LINKED_LIST_MIN_SLAB_NODES)
+            batch_size = LINKED_LIST_MIN_SLAB_NODES;
+        if (batch_size > LINKED_LIST_MAX_SLAB_NODES)
+            batch_size = LINKED_LIST_MAX_SLAB_NODES;
+
+        l->slab = arena_alloc(l->arena_p, batch_size * sizeof(node));
+        if (!l->slab)
+            return NULL;
+        l->slab_left = l->slab_batch_size = batch_size;
+    }
+
+    l->slab_left--;
+    return l->slab++;
 }
 
-linked_list_status linked_list_append(node **nod, void *data)
+linked_list_status linked_list_append(linked_list *l, void *data)
 {
     /* The new node to add to the end of the list */
-    node *new_node = malloc(sizeof(node));
+    node *new_node = take_node(l);
     if (new_node == NULL)
         return LINKED_LIST_NOT_ENOUGH_MEMORY;
-    memset(new_node, 0, sizeof(node));
 
     new_node->data = data;
     new_node->next = NULL;
 
-    if (*nod == NULL)
-        *nod = new_node;
+    if (l->tail == NULL)
+        l->head = new_node;
     else
-    {
-        /* "tmp" holds the actual value of the head; Not a pointer to it. Makes life simpler. */
-        node *tmp = *nod;
-        /* Increment nod to point to the last node in the linked list. */
-        while (tmp->next != NULL)
-            tmp = tmp->next;
-
-        tmp->next = new_node;
-    }
+        l->tail->next = new_node;
+    l->tail = new_node;
+    l->length++;
 
     return LINKED_LIST_OK;
 }
 
-void linked_list_free(node *nod)
+int linked_list_length(linked_list *l)
 {
-    while (nod != NULL)
-    {
-        /* Holds the next node, because I won't be able to access it after I free the current node. */
-        node *next = nod->next;
-        free(nod);
-        nod = next;
-    }
+    return l->length;
 }
 
-void linked_list_free_elements(node *nod) 
+void linked_list_iterator_init(linked_list_iterator *it, linked_list *l)
 {
-    while (nod != NULL)
-    {
-        free(nod->data);
-        nod = nod->next;
-    }
+    it->current = l->head;
 }
 
-int linked_list_length(node* nod)
+boolean linked_list_iterator_next(linked_list_iterator *it, void **data)
 {
-    int count = 0;
+    if (it->current == NULL)
+        return false;
 
-    while (nod != NULL)
-    {
-        count++;
-        nod = nod->next;
-    }
+    *data = it->current->data;
+    it->current = it->current->next;
 
-    return count;
+    return true;
 }
-
-void* linked_list_get(node* nod, int index)
-{   
-    int count = 0;
-
-    while (nod != NULL)
-    {
-        if (count == index)
-            return nod->data;
-
-        count++;
-        nod = nod->next;
-    }
-
-    return NULL;
-}
\ No newline at end of file
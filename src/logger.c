@@ -1,17 +1,75 @@
+#define _POSIX_C_SOURCE 200112L /* For pthread and vsnprintf() */
+
 #include <stdio.h>
 #include <stdarg.h>
+#include <pthread.h>
 
 #include "logger.h"
 
+static pthread_once_t sink_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t sink_key;
+static int sink_key_created = 0;
+
+static void create_sink_key(void)
+{
+    sink_key_created = pthread_key_create(&sink_key, NULL) == 0;
+}
+
+/**
+ * Returns the sink of the calling thread, or NULL if it is the standard output.
+ */
+static logger_sink* get_sink(void)
+{
+    pthread_once(&sink_key_once, create_sink_key);
+    return sink_key_created ? pthread_getspecific(sink_key) : NULL;
+}
+
+logger_sink* logger_redirect(logger_sink* sink_p)
+{
+    logger_sink* previous = get_sink();
+
+    if (sink_key_created)
+        pthread_setspecific(sink_key, sink_p);
+
+    return previous;
+}
+
+/**
+ * Sends the given message to the given sink.
+ */
+static void log_message(logger_sink* sink_p, char* module, char* type, int line, char* message, va_list args)
+{
+    char formatted[LOGGER_MESSAGE_MAX_LENGTH];
+    FILE* stream = sink_p ? sink_p->stream : stdout;
+
+    if (!stream)
+    {
+        vsnprintf(formatted, sizeof(formatted), message, args);
+        sink_p->handler(sink_p->context, module, type, line, formatted);
+        return;
+    }
+
+    if (module)
+        fprintf(stream, "%s: %s (line %d) -> ", module, type, line);
+    vfprintf(stream, message, args);
+    if (module)
+        fprintf(stream, "!\n");
+}
+
 void logger_log(char* module, char* type, int line, char* message, ...)
 {
     va_list args;
 
-    printf("%s: %s (line %d) -> ", module, type, line);
-
     va_start(args, message);
-    vprintf(message, args);
+    log_message(get_sink(), module, type, line, message, args);
     va_end(args);
+}
 
-    printf("!\n");
-}
\ No newline at end of file
+void logger_print(char* message, ...)
+{
+    va_list args;
+
+    va_start(args, message);
+    log_message(get_sink(), NULL, NULL, 0, message, args);
+    va_end(args);
+}
@@ -1,14 +1,59 @@
+#define _POSIX_C_SOURCE 200809L /* For pthread, stat() and open_memstream() */
+
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sys/stat.h>
 
-#include "first_walk.h"
+#include "avisembler.h"
 #include "boolean.h"
-#include "second_walk.h"
 #include "file_writer.h"
+#include "source_file.h"
+#include "logger.h"
+#include "diagnostics.h"
 
 #define DESIRED_INPUT_FILE_EXT "as"
 
+#define SINGLE_PASS_OPTION   "-s"
+#define BINARY_OBJECT_OPTION "-b"
+#define PIPELINE_OPTION      "-p"
+#define JOBS_OPTION          "-j"
+
+typedef struct s_options
+{
+    boolean single_pass;   /**< Should the files be compiled in a single pass, instead of two walks? */
+    boolean binary_object; /**< Should a binary object file (".obb") be written too? */
+    boolean pipelined;     /**< Should every file be read and parsed by a pipeline of threads? Prints it's counters. */
+    int jobs;              /**< How many files should be compiled in parallel? 0 - one after the other, by the main thread. */
+    int file_threads;      /**< How many threads may the walks of a single file use? */
+} options;
+
+typedef struct s_job
+{
+    char *file_name;    /**< The file to compile. */
+    off_t size;         /**< The size of the file. The largest files are compiled first. */
+    int index;          /**< The index of the file in the arguments. */
+    char *messages;     /**< The messages of the compilation. Allocated by open_memstream(), MUST BE FREED. */
+    size_t messages_length;
+    char *stats;        /**< The counters of the pipeline (PIPELINE_OPTION), for the standard error. Allocated by
+                             open_memstream(), MUST BE FREED. */
+    size_t stats_length;
+    boolean done;       /**< Is the compilation done? */
+} job;
+
+typedef struct s_worker_pool
+{
+    job *jobs;              /**< The jobs, in the order of the arguments. */
+    job **queue;            /**< The jobs, the largest file first. */
+    int jobs_count;
+    int next;               /**< The index (In the queue) of the next job to take. */
+    options *options_p;     /**< The options of the compilation. */
+    pthread_mutex_t mutex;  /**< Guards next and the done flags. */
+    pthread_cond_t job_done;
+} worker_pool;
+
 /**
  * @brief Checks if the given file name ends with DESIRED_INPUT_FILE_EXT
  * 
@@ -26,74 +71,326 @@ boolean has_legal_extension(char *file_name)
 }
 
 /**
- * @brief Compiles the given assembly file.
+ * @brief Checks if the argument in the given index is an option.
  * 
- * @param file_name The file to compile.
+ * @param argc      The number of arguments.
+ * @param argv      The arguments.
+ * @param i         The index of the argument to check.
+ * @param options_p A pointer to the options; The option is turned on. May be NULL.
+ * @return int How many arguments the option takes (1, or 2 for JOBS_OPTION and it's number), 0 if it is not an
+ *             option, or -1 if the option is invalid.
  */
-void compile(char *file_name)
+int parse_option(int argc, char *argv[], int i, options *options_p)
 {
-    symbols_table st = linked_list_create();
-    unsigned char *code_image, *data_image;
-    unsigned long dcf, icf;
-    walk_status fw_status;
-    walk_status sw_status;
+    char *end;
+    long jobs;
+
+    if (strcmp(argv[i], SINGLE_PASS_OPTION) == 0 || strcmp(argv[i], BINARY_OBJECT_OPTION) == 0 || strcmp(argv[i], PIPELINE_OPTION) == 0)
+    {
+        if (options_p)
+        {
+            options_p->single_pass |= strcmp(argv[i], SINGLE_PASS_OPTION) == 0;
+            options_p->binary_object |= strcmp(argv[i], BINARY_OBJECT_OPTION) == 0;
+            options_p->pipelined |= strcmp(argv[i], PIPELINE_OPTION) == 0;
+        }
+        return 1;
+    }
 
-    file_writer_status object_status, entries_status, externals_status;
+    if (strcmp(argv[i], JOBS_OPTION) != 0)
+        return 0;
+
+    if (i + 1 == argc)
+        return -1;
+    jobs = strtol(argv[i + 1], &end, 10);
+    if (end == argv[i + 1] || *end != '\0' || jobs < 1)
+        return -1;
+
+    if (options_p)
+        options_p->jobs = (int) jobs;
+    return 2;
+}
+
+/**
+ * @brief Prints the counters of the pipeline of the given file.
+ * 
+ * @param stream    Where to print them - the standard error, or the stream of the file's job.
+ * @param file_name The file.
+ * @param stats_p   The counters.
+ */
+void print_pipeline_stats(FILE *stream, char *file_name, pipeline_stats *stats_p)
+{
+    fprintf(stream, "%s: reader -> parser: %lu lines, max depth %lu, %lu full stalls, %lu empty stalls; "
+                    "parser -> walk: %lu items, max depth %lu, %lu full stalls, %lu empty stalls\n", file_name,
+            stats_p->lines.items, stats_p->lines.max_depth, stats_p->lines.producer_stalls, stats_p->lines.consumer_stalls,
+            stats_p->commands.items, stats_p->commands.max_depth, stats_p->commands.producer_stalls, stats_p->commands.consumer_stalls);
+}
+
+/**
+ * @brief Compiles the given assembly file, and writes the output files.
+ * 
+ * @param file_name    The file to compile.
+ * @param options_p    The options of the compilation.
+ * @param assembler_p  The assembler context. (It's single_pass is set by the options)
+ * @param stats_stream Where to print the counters of the pipeline (If options_p->pipelined).
+ */
+void compile(char *file_name, options *options_p, avisembler *assembler_p, FILE *stats_stream)
+{
+    source_file source;
+    source_file_status source_status;
+    avisembler_result result;
+    avisembler_status status;
+    unsigned long next_diagnostic = 0;
+
+    file_writer_status object_status, entries_status, externals_status, binary_object_status = FILE_WRITER_OK;
 
     if (!has_legal_extension(file_name))
     {
-        printf("Error: File \"%s\" has no \".%s\" extension. Skipping.\n", file_name, DESIRED_INPUT_FILE_EXT);
+        logger_print("Error: File \"%s\" has no \".%s\" extension. Skipping.\n", file_name, DESIRED_INPUT_FILE_EXT);
         return;
     }
 
-    fw_status = first_walk(file_name, &st);
-    if (fw_status == WALK_NOT_ENOUGH_MEMORY)
+    /* The source is mapped once, and assembled in memory */
+    source_status = source_file_open(file_name, &source);
+    if (source_status == SOURCE_FILE_IO_ERROR)
     {
-        printf("Error: Not enough memory!\n");
-        goto first_walk_free;
+        logger_print("Error: Cannot open file \"%s\". Skipping.\n", file_name);
+        return;
     }
-    if (fw_status != WALK_OK) /* If it another error, I already logged it */
-        goto first_walk_free;
+    if (source_status == SOURCE_FILE_NOT_ENOUGH_MEMORY)
+    {
+        logger_print("Error: Not enough memory!\n");
+        return;
+    }
+
+    assembler_p->single_pass = options_p->single_pass;
+    assembler_p->threads = options_p->file_threads;
+    assembler_p->pipelined = options_p->pipelined;
+    status = avisembler_assemble(assembler_p, source.content, source.size, &result);
+    source_file_close(&source);
+
+    if (options_p->pipelined)
+        print_pipeline_stats(stats_stream, file_name, &assembler_p->pipeline_stats);
 
-    sw_status = second_walk(file_name, &st, &data_image, &dcf, &code_image, &icf);
-    if (sw_status == WALK_NOT_ENOUGH_MEMORY)
+    diagnostics_replay(result.diagnostics, result.diagnostics_count, &next_diagnostic, INT_MAX, 0);
+
+    if (status == AVISEMBLER_NOT_ENOUGH_MEMORY)
     {
-        printf("Error: Not enough memory!\n");
-        goto second_walk_free;
+        logger_print("Error: Not enough memory!\n");
+        return;
     }
-    if (sw_status != WALK_OK) /* If it another error, I already logged it */
-        goto second_walk_free;
+    if (status != AVISEMBLER_OK) /* The problems are the diagnostics, which were already printed */
+        return;
 
-    object_status = write_object_file(file_name, data_image, dcf, code_image, icf);
-    entries_status = write_entries_file(file_name, st);
-    externals_status = write_externals_file(file_name, st);
-    if (object_status == FILE_WRITER_NOT_ENOUGH_MEMORY || entries_status == FILE_WRITER_NOT_ENOUGH_MEMORY || externals_status == FILE_WRITER_NOT_ENOUGH_MEMORY)
-        printf("Error: Not enough memory!\n");
-    /* If there is another error, I already logged it, and we can continue to clean up. Else, we can continue to clean up... */
+    object_status = write_object_file(file_name, &result);
+    entries_status = write_entries_file(file_name, &result);
+    externals_status = write_externals_file(file_name, &result);
+    if (options_p->binary_object)
+        binary_object_status = write_binary_object_file(file_name, &result);
+    if (object_status == FILE_WRITER_NOT_ENOUGH_MEMORY || entries_status == FILE_WRITER_NOT_ENOUGH_MEMORY || externals_status == FILE_WRITER_NOT_ENOUGH_MEMORY ||
+        binary_object_status == FILE_WRITER_NOT_ENOUGH_MEMORY)
+        logger_print("Error: Not enough memory!\n");
+    /* If there is another error, I already logged it. The result stays in the context until the next file */
+}
 
-    /* Clean up */
-    second_walk_free:
-    if (data_image) /* If it is null, it was not allocated! */
-        free(data_image);
-    if (code_image) /* If it is null, it was not allocated! */
-        free(code_image);
+/**
+ * @brief Orders the jobs so the largest file comes first. Files of the same size stay in the order of the arguments.
+ */
+int compare_jobs(const void *a, const void *b)
+{
+    job *first = *(job **) a, *second = *(job **) b;
 
-    first_walk_free:
-    free_symbols_table(st); /* Nothing will happen if it was not allocated */
+    if (first->size != second->size)
+        return first->size > second->size ? -1 : 1;
+    return first->index - second->index;
+}
+
+/**
+ * @brief The worker thread - takes the next job from the queue, and compiles it, until the queue is empty. The
+ *        messages of every compilation are kept aside, so they can be printed together.
+ * 
+ * @param arg A pointer to the worker pool.
+ * @return void* NULL.
+ */
+void *worker(void *arg)
+{
+    worker_pool *pool_p = arg;
+    avisembler assembler;
+    job *job_p;
+    FILE *messages, *stats;
+    logger_sink sink;
+
+    avisembler_init(&assembler);
+    sink.handler = NULL;
+    sink.context = NULL;
+    while (true)
+    {
+        pthread_mutex_lock(&pool_p->mutex);
+        job_p = pool_p->next < pool_p->jobs_count ? pool_p->queue[pool_p->next++] : NULL;
+        pthread_mutex_unlock(&pool_p->mutex);
+        if (!job_p)
+            break;
+
+        /* If there is no memory for the streams, the messages (And the counters) go straight to the standard output
+           (And error) */
+        messages = open_memstream(&job_p->messages, &job_p->messages_length);
+        stats = pool_p->options_p->pipelined ? open_memstream(&job_p->stats, &job_p->stats_length) : NULL;
+        sink.stream = messages;
+        logger_redirect(messages ? &sink : NULL);
+        compile(job_p->file_name, pool_p->options_p, &assembler, stats ? stats : stderr);
+        logger_redirect(NULL);
+        if (messages)
+            fclose(messages);
+        if (stats)
+            fclose(stats);
+
+        pthread_mutex_lock(&pool_p->mutex);
+        job_p->done = true;
+        pthread_cond_broadcast(&pool_p->job_done);
+        pthread_mutex_unlock(&pool_p->mutex);
+    }
+    avisembler_free(&assembler);
+
+    return NULL;
+}
+
+/**
+ * @brief Compiles the given files by a pool of worker threads. The messages of every file are printed together, in
+ *        the order of the files.
+ * 
+ * @param file_names  The files to compile.
+ * @param files_count How many files are there?
+ * @param options_p   The options of the compilation. options_p->jobs is the number of the workers.
+ * @return boolean False if there is not enough memory, else true.
+ */
+boolean compile_parallel(char *file_names[], int files_count, options *options_p)
+{
+    worker_pool pool;
+    pthread_t *threads;
+    int i, threads_count, created = 0;
+    struct stat file_stat;
+
+    threads_count = options_p->jobs < files_count ? options_p->jobs : files_count;
+    pool.jobs = malloc(sizeof(job) * files_count);
+    pool.queue = malloc(sizeof(job *) * files_count);
+    threads = malloc(sizeof(pthread_t) * threads_count);
+    if (!pool.jobs || !pool.queue || !threads)
+    {
+        free(pool.jobs);
+        free(pool.queue);
+        free(threads);
+        return false;
+    }
+
+    for (i = 0; i < files_count; i++)
+    {
+        pool.jobs[i].file_name = file_names[i];
+        pool.jobs[i].size = stat(file_names[i], &file_stat) == 0 ? file_stat.st_size : 0; /* compile() reports errors */
+        pool.jobs[i].index = i;
+        pool.jobs[i].messages = NULL;
+        pool.jobs[i].messages_length = 0;
+        pool.jobs[i].stats = NULL;
+        pool.jobs[i].stats_length = 0;
+        pool.jobs[i].done = false;
+        pool.queue[i] = &pool.jobs[i];
+    }
+    qsort(pool.queue, files_count, sizeof(job *), compare_jobs);
+
+    pool.jobs_count = files_count;
+    pool.next = 0;
+    pool.options_p = options_p;
+    pthread_mutex_init(&pool.mutex, NULL);
+    pthread_cond_init(&pool.job_done, NULL);
+
+    for (i = 0; i < threads_count; i++)
+        if (pthread_create(&threads[created], NULL, worker, &pool) == 0)
+            created++;
+    if (created == 0) /* No threads - so the main thread does all of the work */
+        worker(&pool);
+
+    /* Print the messages (And the counters) of every file as soon as it, and all of the files before it, are done */
+    for (i = 0; i < files_count; i++)
+    {
+        pthread_mutex_lock(&pool.mutex);
+        while (!pool.jobs[i].done)
+            pthread_cond_wait(&pool.job_done, &pool.mutex);
+        pthread_mutex_unlock(&pool.mutex);
+
+        if (pool.jobs[i].stats)
+        {
+            fflush(stdout);
+            fwrite(pool.jobs[i].stats, 1, pool.jobs[i].stats_length, stderr);
+        }
+        if (pool.jobs[i].messages)
+            fwrite(pool.jobs[i].messages, 1, pool.jobs[i].messages_length, stdout);
+        free(pool.jobs[i].stats);
+        free(pool.jobs[i].messages);
+    }
+
+    for (i = 0; i < created; i++)
+        pthread_join(threads[i], NULL);
+    pthread_cond_destroy(&pool.job_done);
+    pthread_mutex_destroy(&pool.mutex);
+    free(threads);
+    free(pool.queue);
+    free(pool.jobs);
+
+    return true;
 }
 
 int main(int argc, char *argv[])
 {
-    int i;
+    int i, consumed, files_count = 0;
+    char **file_names;
+    avisembler assembler;
+    options compilation_options;
 
+    compilation_options.single_pass = compilation_options.binary_object = compilation_options.pipelined = false;
+    compilation_options.jobs = 0;
     if (argc == 1)
     {
-        printf("Usage: \"%s file1.asm file2.asm ...\"\n", argv[0]);
+        printf("Usage: \"%s [%s] [%s] [%s] [%s N] file1.asm file2.asm ...\"\n", argv[0], SINGLE_PASS_OPTION, BINARY_OBJECT_OPTION, PIPELINE_OPTION, JOBS_OPTION);
+        return 1;
+    }
+
+    file_names = malloc(sizeof(char *) * argc);
+    if (!file_names)
+    {
+        printf("Error: Not enough memory!\n");
         return 1;
     }
 
-    for (i = 1; i < argc; i++)
-        compile(argv[i]);
+    /* The options may come anywhere, and apply to all of the files */
+    for (i = 1; i < argc; i += consumed ? consumed : 1)
+    {
+        consumed = parse_option(argc, argv, i, &compilation_options);
+        if (consumed < 0)
+        {
+            printf("Error: Option \"%s\" needs a positive number of jobs.\n", JOBS_OPTION);
+            free(file_names);
+            return 1;
+        }
+        if (consumed == 0)
+            file_names[files_count++] = argv[i];
+    }
+
+    /* When there are less files than jobs, the rest of the threads go to the walks of the files */
+    compilation_options.file_threads = 1;
+    if (files_count > 0 && compilation_options.jobs > files_count)
+        compilation_options.file_threads = compilation_options.jobs / files_count;
 
+    if (compilation_options.jobs > 0)
+    {
+        if (!compile_parallel(file_names, files_count, &compilation_options))
+            printf("Error: Not enough memory!\n");
+    }
+    else
+    {
+        avisembler_init(&assembler);
+        for (i = 0; i < files_count; i++)
+            compile(file_names[i], &compilation_options, &assembler, stderr);
+        avisembler_free(&assembler);
+    }
+
+    free(file_names);
     return 0;
-}
\ No newline at end of file
+}
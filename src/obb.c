@@ -0,0 +1,188 @@
+#include "obb.h"
+#include "source_file.h"
+#include "boolean.h"
+
+#include <string.h>
+
+#define U32_SIZE 4
+
+/* The offsets of the fields in the header */
+#define HEADER_VERSION_OFFSET         4
+#define HEADER_FLAGS_OFFSET           8
+#define HEADER_CODE_ADDRESS_OFFSET    12
+#define HEADER_ICF_OFFSET             16
+#define HEADER_DCF_OFFSET             20
+#define HEADER_ENTRIES_COUNT_OFFSET   24
+#define HEADER_EXTERNALS_COUNT_OFFSET 28
+
+#define KNOWN_FLAGS (OBB_FLAG_ENTRIES | OBB_FLAG_EXTERNALS)
+
+/**
+ * @brief Puts the given number as a 32 bit little endian number.
+ *
+ * @param out    Where to put it.
+ * @param number The number.
+ */
+static void put_u32(unsigned char *out, unsigned long number)
+{
+    out[0] = (unsigned char) (number & 0xFF);
+    out[1] = (unsigned char) ((number >> 8) & 0xFF);
+    out[2] = (unsigned char) ((number >> 16) & 0xFF);
+    out[3] = (unsigned char) ((number >> 24) & 0xFF);
+}
+
+/**
+ * @brief Reads a 32 bit little endian number.
+ *
+ * @param in Where to read from.
+ * @return unsigned long The number.
+ */
+static unsigned long get_u32(unsigned char *in)
+{
+    return (unsigned long) in[0] | ((unsigned long) in[1] << 8) | ((unsigned long) in[2] << 16) | ((unsigned long) in[3] << 24);
+}
+
+void obb_encode_header(obb_header *header, unsigned char *out)
+{
+    memcpy(out, OBB_MAGIC, OBB_MAGIC_SIZE);
+    put_u32(out + HEADER_VERSION_OFFSET, header->version);
+    put_u32(out + HEADER_FLAGS_OFFSET, header->flags);
+    put_u32(out + HEADER_CODE_ADDRESS_OFFSET, header->code_address);
+    put_u32(out + HEADER_ICF_OFFSET, header->icf);
+    put_u32(out + HEADER_DCF_OFFSET, header->dcf);
+    put_u32(out + HEADER_ENTRIES_COUNT_OFFSET, header->entries_count);
+    put_u32(out + HEADER_EXTERNALS_COUNT_OFFSET, header->externals_count);
+}
+
+void obb_encode_symbol_row(char *name, unsigned long address, unsigned char *out)
+{
+    size_t length = strlen(name);
+    if (length > OBB_SYMBOL_NAME_SIZE - 1)
+        length = OBB_SYMBOL_NAME_SIZE - 1;
+
+    put_u32(out, address);
+    memset(out + U32_SIZE, 0, OBB_SYMBOL_NAME_SIZE);
+    memcpy(out + U32_SIZE, name, length);
+}
+
+size_t obb_padding_size(obb_header *header)
+{
+    size_t images_size = (header->icf - header->code_address) + header->dcf;
+    return (OBB_ALIGNMENT - images_size % OBB_ALIGNMENT) % OBB_ALIGNMENT;
+}
+
+/**
+ * @brief Checks that every name in the given table is null terminated, so it can be used as it is.
+ *
+ * @param table The table.
+ * @param count How many rows are in the table?
+ * @return boolean True or False.
+ */
+static boolean is_valid_table(unsigned char *table, unsigned long count)
+{
+    unsigned long i;
+
+    for (i = 0; i < count; i++)
+        if (table[i * OBB_SYMBOL_ROW_SIZE + OBB_SYMBOL_ROW_SIZE - 1] != '\0')
+            return false;
+
+    return true;
+}
+
+obb_status obb_open(char *file_name, obb_file *obb_p)
+{
+    unsigned char *content;
+    obb_header *header = &obb_p->header;
+    size_t size, code_size, offset;
+
+    switch (source_file_open(file_name, &obb_p->source))
+    {
+    case SOURCE_FILE_IO_ERROR:
+        return OBB_IO_ERROR;
+    case SOURCE_FILE_NOT_ENOUGH_MEMORY:
+        return OBB_NOT_ENOUGH_MEMORY;
+    default:
+        break;
+    }
+    content = (unsigned char *) obb_p->source.content;
+    size = obb_p->source.size;
+
+    if (size < OBB_HEADER_SIZE || memcmp(content, OBB_MAGIC, OBB_MAGIC_SIZE) != 0)
+        goto invalid;
+
+    header->version = get_u32(content + HEADER_VERSION_OFFSET);
+    header->flags = get_u32(content + HEADER_FLAGS_OFFSET);
+    header->code_address = get_u32(content + HEADER_CODE_ADDRESS_OFFSET);
+    header->icf = get_u32(content + HEADER_ICF_OFFSET);
+    header->dcf = get_u32(content + HEADER_DCF_OFFSET);
+    header->entries_count = get_u32(content + HEADER_ENTRIES_COUNT_OFFSET);
+    header->externals_count = get_u32(content + HEADER_EXTERNALS_COUNT_OFFSET);
+
+    if (header->version != OBB_VERSION || (header->flags & ~(unsigned long) KNOWN_FLAGS) || header->icf < header->code_address)
+        goto invalid;
+    if (!(header->flags & OBB_FLAG_ENTRIES) && header->entries_count != 0)
+        goto invalid;
+    if (!(header->flags & OBB_FLAG_EXTERNALS) && header->externals_count != 0)
+        goto invalid;
+
+    /* Check the sizes one part at a time, so nothing can overflow */
+    code_size = header->icf - header->code_address;
+    offset = OBB_HEADER_SIZE;
+    if (code_size > size - offset || header->dcf > size - offset - code_size)
+        goto invalid;
+    offset += code_size + header->dcf;
+    if (obb_padding_size(header) > size - offset)
+        goto invalid;
+    offset += obb_padding_size(header);
+    if (header->entries_count > (size - offset) / OBB_SYMBOL_ROW_SIZE)
+        goto invalid;
+    offset += header->entries_count * OBB_SYMBOL_ROW_SIZE;
+    if (header->externals_count > (size - offset) / OBB_SYMBOL_ROW_SIZE)
+        goto invalid;
+
+    obb_p->code_image = content + OBB_HEADER_SIZE;
+    obb_p->data_image = obb_p->code_image + code_size;
+    obb_p->entries_table = (header->flags & OBB_FLAG_ENTRIES) ? content + offset - header->entries_count * OBB_SYMBOL_ROW_SIZE : NULL;
+    obb_p->externals_table = (header->flags & OBB_FLAG_EXTERNALS) ? content + offset : NULL;
+
+    if (obb_p->entries_table && !is_valid_table(obb_p->entries_table, header->entries_count))
+        goto invalid;
+    if (obb_p->externals_table && !is_valid_table(obb_p->externals_table, header->externals_count))
+        goto invalid;
+
+    return OBB_OK;
+
+invalid:
+    source_file_close(&obb_p->source);
+    return OBB_INVALID;
+}
+
+/**
+ * @brief Gives a row of the given table.
+ *
+ * @param table    The table.
+ * @param index    The index of the row.
+ * @param symbol_p A pointer to where to put the row.
+ */
+static void get_symbol_row(unsigned char *table, unsigned long index, obb_symbol *symbol_p)
+{
+    unsigned char *row = table + index * OBB_SYMBOL_ROW_SIZE;
+
+    symbol_p->address = get_u32(row);
+    symbol_p->name = (char *) (row + U32_SIZE);
+}
+
+void obb_get_entry(obb_file *obb_p, unsigned long index, obb_symbol *symbol_p)
+{
+    get_symbol_row(obb_p->entries_table, index, symbol_p);
+}
+
+void obb_get_external(obb_file *obb_p, unsigned long index, obb_symbol *symbol_p)
+{
+    get_symbol_row(obb_p->externals_table, index, symbol_p);
+}
+
+void obb_close(obb_file *obb_p)
+{
+    source_file_close(&obb_p->source);
+}
@@ -3,12 +3,8 @@
 #include "directives_table.h"
 #include "logger.h"
 #include "str_helper.h"
-#include "utils.h"
 
 #include <string.h>
-#include <stdlib.h>
-#include <limits.h>
-#include <errno.h>
 
 #define OPERANDS_VALIDATOR "OperandsValidator"
 #define INVALID_OPERANDS "InvalidOperands"
@@ -16,8 +12,6 @@
 #define FIRST_REGISTER 0
 #define LAST_REGISTER 31
 
-#define BITS_PER_BYTE 8
-
 #define BYTE_SIZE 1
 #define HALF_SIZE 2
 #define WORD_SIZE 4
@@ -25,32 +19,37 @@
 #define REGISTER_STR_MIN_LENGTH 2
 #define REGISTER_STR_MAX_LENGTH 4 /* For example - $+31 */
 
+typedef struct s_constant_bounds
+{
+    long min, max;
+} constant_bounds;
+
+/* The 2's complement range of a constant, by it's width in bytes */
+static const constant_bounds bounds[WORD_SIZE + 1] = {
+    {0, 0},
+    {-0x80L, 0x7FL},                 /* BYTE_SIZE */
+    {-0x8000L, 0x7FFFL},             /* HALF_SIZE */
+    {0, 0},
+    {-0x7FFFFFFFL - 1, 0x7FFFFFFFL}  /* WORD_SIZE */
+};
+
 /**
  * @brief Returnes the required number of operands for the the given command.
  * 
- * @param command  The command. MUST EXIST.
+ * @param command  The command. MUST BE RESOLVED (See validate_command_name()).
  * @return int     The required number of operands.
  */
 int get_required_number_of_operands(command cmd)
 {
-    instruction* inst;
-    directive* dir;
-
     if (cmd.type == INSTRUCTION)
-    {
-        instructions_table_get_instruction(cmd.command_name, &inst);
-        return inst->number_of_operands;
-    }
+        return cmd.inst->number_of_operands;
     else /* A directive */
-    {
-        directives_table_get_directive(cmd.command_name, &dir);
-        return dir->number_of_operands;
-    }
+        return cmd.dir->number_of_operands;
 }
 
 /**
  * Checks if the operands length of the given command is valid.
- * @param cmd  The commnad to check. The command name must exist.
+ * @param cmd  The commnad to check. The command name must be resolved.
  * @param line On what line these operands are?
  * @return VALIDATOR_INVALID or VALIDATOR_OK.
  */
@@ -88,37 +87,29 @@ validator_status validate_operands_length(command cmd, int line)
 /**
  * @brief Returnes the operands types array of the given command.
  * 
- * @param command         The command. MUST EXIST.
+ * @param command         The command. MUST BE RESOLVED (See validate_command_name()).
  * @return operand_type* The operands types array.
  */
 operand_type* get_operands_types(command cmd)
 {
-    instruction* inst;
-    directive* dir;
-
     if (cmd.type == INSTRUCTION)
-    {
-        instructions_table_get_instruction(cmd.command_name, &inst);
-        return inst->operands_types;
-    }
+        return cmd.inst->operands_types;
     else /* A directive */
-    {
-        directives_table_get_directive(cmd.command_name, &dir);
-        return dir->operands_types;
-    }
+        return cmd.dir->operands_types;
 }
 
 /**
- * @brief This method checks if the given operand is a valid register.
+ * @brief This method checks if the given operand is a valid register, and converts it.
  * 
  * @param operand The operand to check.
+ * @param value_p A pointer to where to put the number of the register.
  * @param line    On what line this operand is?
  * @return validator_status VALIDATOR_INVALID or VALIDATOR_OK
  */
-validator_status validate_register_operand(char* operand, int line)
+validator_status validate_register_operand(char* operand, long *value_p, int line)
 {
     size_t length;
-    int register_value;
+    boolean is_number;
 
     /* Make sure that the register is written well */
     if (operand[0] != '$')
@@ -127,7 +118,9 @@ validator_status validate_register_operand(char* operand, int line)
         return VALIDATOR_INVALID;
     }
 
-    length = strlen(operand);
+    /* The register number itself is after the '$' */
+    is_number = parse_number(operand + 1, value_p, &length);
+    length++; /* The '$' */
     if (length < REGISTER_STR_MIN_LENGTH || length > REGISTER_STR_MAX_LENGTH)
     {
         logger_log(OPERANDS_VALIDATOR, INVALID_OPERANDS, line, "The register length must be between 2 and 3");
@@ -135,17 +128,15 @@ validator_status validate_register_operand(char* operand, int line)
     }
 
     /* Make sure that the register name is valid */
-    operand++; /* Point to the register number itself */
-    if (!is_number(operand))
+    if (!is_number)
     {
         logger_log(OPERANDS_VALIDATOR, INVALID_OPERANDS, line, "The register value must be a number");
         return VALIDATOR_INVALID;
     }
-    register_value = atoi(operand);
 
-    if (register_value < FIRST_REGISTER || register_value > LAST_REGISTER)
+    if (*value_p < FIRST_REGISTER || *value_p > LAST_REGISTER)
     {
-        logger_log(OPERANDS_VALIDATOR, INVALID_OPERANDS, line, "Register number %d is out of range. Must be between %d and %d", register_value, FIRST_REGISTER, LAST_REGISTER);
+        logger_log(OPERANDS_VALIDATOR, INVALID_OPERANDS, line, "Register number %d is out of range. Must be between %d and %d", (int) *value_p, FIRST_REGISTER, LAST_REGISTER);
         return VALIDATOR_INVALID;
     }
 
@@ -153,29 +144,28 @@ validator_status validate_register_operand(char* operand, int line)
 }
 
 /**
- * @brief Checks if the given operand is a valid constant.
+ * @brief Checks if the given operand is a valid constant, and converts it.
  * 
  * @param operand The operand to check.
- * @param width   The width that the operand should be. (In bytes). Must be less than long size.
+ * @param width   The width that the operand should be. (In bytes) - BYTE_SIZE or HALF_SIZE or WORD_SIZE.
+ * @param value_p A pointer to where to put the constant.
  * @param line    On what line this operand is?
  * @return validator_status VALIDATOR_OK or VALIDATOR_INVALID
  */
-validator_status validate_constant_operand(char* operand, int width, int line)
+validator_status validate_constant_operand(char* operand, int width, long *value_p, int line)
 {
-    long num;
-    
-    if (!is_number(operand))
+    size_t length;
+
+    if (!parse_number(operand, value_p, &length))
     {
         logger_log(OPERANDS_VALIDATOR, INVALID_OPERANDS, line, "Constant \"%s\" is not a number", operand);
         return VALIDATOR_INVALID;
     }
 
-    num = strtol(operand, 0, 10);
-
-    /* Check the range */
-    if (!is_in_range_2_complement(num, width * BITS_PER_BYTE) || (num == LONG_MIN && errno == ERANGE) || (num == LONG_MAX && errno == ERANGE))
+    /* Check the range. A number that does not fit in a long is saturated, so it is out of range too. */
+    if (*value_p < bounds[width].min || *value_p > bounds[width].max)
     {
-        logger_log(OPERANDS_VALIDATOR, INVALID_OPERANDS, line, "The number %ld must fit into %d bytes in 2's complement", num, width);
+        logger_log(OPERANDS_VALIDATOR, INVALID_OPERANDS, line, "The number %ld must fit into %d bytes in 2's complement", *value_p, width);
         return VALIDATOR_INVALID;
     }
 
@@ -202,39 +192,42 @@ validator_status validate_label_operand(char* operand, int line)
  * @brief Checks if the given operand matchs to label or register.
  * 
  * @param operand The operand to check.
+ * @param value_p A pointer to where to put the number of the register (If it is a register).
  * @param line    On what line this operand is?
  * @return validator_status VALIDATOR_OK or VALIDATOR_INVALID
  */
-validator_status validate_label_or_register(char* operand, int line)
+validator_status validate_label_or_register(char* operand, long *value_p, int line)
 {
     if (*operand == '$') /* This is a register. A label cannot start with '$' */
-        return validate_register_operand(operand, line);
+        return validate_register_operand(operand, value_p, line);
     else /* This is a label */
         return validate_label_operand(operand, line);
 }
 
 /**
- * @brief Checks if the given operand matchs to the given operand type.
+ * @brief Checks if the given operand matchs to the given operand type, and converts it (If it is a register or a
+ *        constant).
  * 
  * @param operand The operand to check.
  * @param type    The desired operand type.
+ * @param value_p A pointer to where to put the value of the operand.
  * @param line    On what line this operand is?
  * @return validator_status VALIDATOR_OK or VALIDATOR_INVALID
  */
-validator_status validate_operand_type(char* operand, operand_type type, int line)
+validator_status validate_operand_type(char* operand, operand_type type, long *value_p, int line)
 {
     switch (type)
     {
         case REGISTER:
-            return validate_register_operand(operand, line);
+            return validate_register_operand(operand, value_p, line);
         case CONSTANT_BYTE:
-            return validate_constant_operand(operand, BYTE_SIZE, line);
+            return validate_constant_operand(operand, BYTE_SIZE, value_p, line);
         case CONSTANT_HALF:
-            return validate_constant_operand(operand, HALF_SIZE, line);
+            return validate_constant_operand(operand, HALF_SIZE, value_p, line);
         case CONSTANT_WORD:
-            return validate_constant_operand(operand, WORD_SIZE, line);
+            return validate_constant_operand(operand, WORD_SIZE, value_p, line);
         case LABEL_OR_REGISTER:
-            return validate_label_or_register(operand, line);
+            return validate_label_or_register(operand, value_p, line);
         case LABEL:
             return validate_label_operand(operand, line);
         default:
@@ -244,7 +237,7 @@ validator_status validate_operand_type(char* operand, operand_type type, int lin
 
 /**
  * Checks if the operands types of the given command is valid.
- * @param cmd The commnad to check. The command name must exist, the number of operands must be correct.
+ * @param cmd The commnad to check. The command name must be resolved, the number of operands must be correct.
  * @param line On what line these operands are?
  * @return VALIDATOR_INVALID or VALIDATOR_OK.
 */
@@ -260,13 +253,50 @@ validator_status validate_operands_type(command cmd, int line)
     /* Now, check every operand */
     for (i = 0; i < cmd.number_of_operands; i++)
     {
-        if ((status = validate_operand_type(cmd.operands[i], required_number_of_operands == DT_INFINITY ? operands_types[0] : operands_types[i], line)) != VALIDATOR_OK)
+        if ((status = validate_operand_type(cmd.operands[i], required_number_of_operands == DT_INFINITY ? operands_types[0] : operands_types[i], &cmd.values[i], line)) != VALIDATOR_OK)
             return status;
     }
 
     return VALIDATOR_OK;
 }
 
+/**
+ * @brief Checks the values of a ".space" or ".fill" directive, which depend on each other: The count must not be
+ *        negative, and the value of ".fill" must fit into it's size - which is BYTE_SIZE or HALF_SIZE or WORD_SIZE.
+ * 
+ * @param cmd  The command to check. It's operands types must be valid.
+ * @param line On what line this command is?
+ * @return validator_status VALIDATOR_OK or VALIDATOR_INVALID
+ */
+validator_status validate_run_values(command cmd, int line)
+{
+    long size;
+
+    if (cmd.values[0] < 0)
+    {
+        logger_log(OPERANDS_VALIDATOR, INVALID_OPERANDS, line, "Directive \".%s\" cannot reserve a negative size (%ld)", cmd.command_name, cmd.values[0]);
+        return VALIDATOR_INVALID;
+    }
+
+    if (cmd.dir->id == DIRECTIVE_SPACE)
+        return VALIDATOR_OK;
+
+    size = cmd.values[2];
+    if (size != BYTE_SIZE && size != HALF_SIZE && size != WORD_SIZE)
+    {
+        logger_log(OPERANDS_VALIDATOR, INVALID_OPERANDS, line, "The size of the value must be %d, %d or %d bytes, given %ld", BYTE_SIZE, HALF_SIZE, WORD_SIZE, size);
+        return VALIDATOR_INVALID;
+    }
+
+    if (cmd.values[1] < bounds[size].min || cmd.values[1] > bounds[size].max)
+    {
+        logger_log(OPERANDS_VALIDATOR, INVALID_OPERANDS, line, "The number %ld must fit into %d bytes in 2's complement", cmd.values[1], (int) size);
+        return VALIDATOR_INVALID;
+    }
+
+    return VALIDATOR_OK;
+}
+
 validator_status validate_operands(command cmd, int line)
 {
     validator_status status;
@@ -277,5 +307,8 @@ validator_status validate_operands(command cmd, int line)
     if ((status = validate_operands_type(cmd, line)) != VALIDATOR_OK)
         return status;
 
+    if (cmd.type == DIRECTIVE && (cmd.dir->id == DIRECTIVE_SPACE || cmd.dir->id == DIRECTIVE_FILL))
+        return validate_run_values(cmd, line);
+
     return VALIDATOR_OK;
 }
\ No newline at end of file
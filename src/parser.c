@@ -1,10 +1,7 @@
 #include "parser.h"
 #include "boolean.h"
-#include "str_helper.h"
 #include "logger.h"
 
-#include <stdlib.h>
-#include <ctype.h>
 #include <string.h>
 
 #define MAX_LABEL 31
@@ -13,385 +10,318 @@
 #define SYNTAX_ERROR "SyntaxError"
 #define OVERFLOW_ERROR "OverflowError"
 
-/**
- * Checks if there is a label inside of the given string.
- * @param str The string to check.
- * @return if there is a label.
+/*
+ * The line is read once, from left to right. Every char is classified by a table, and moves a lexer (A small DFA)
+ * from state to state - the transitions mark where the command name and the operands start and end, and the syntax
+ * errors are states of their own.
+ * Whether the line has a label is known only at it's end (The label is everything up to the first colon - but only if
+ * there is a colon outside of quotes, anywhere in the line). So one lexer reads the line as if it has no label, and
+ * from the first colon, another lexer reads it as if it has one; The first lexer stops as soon as a label is certain.
  */
-static boolean has_label(char *str)
-{
-    boolean inside_quotes = false;
-
-    while (*str)
-    {
-        if (*str == '"')
-            inside_quotes = !inside_quotes;
-        else if (*str == ':' && !inside_quotes)
-            return true;
 
-        str++;
-    }
+typedef enum e_char_class
+{
+    CLASS_END,       /* '\0' */
+    CLASS_SPACE,     /* Like isspace() */
+    CLASS_QUOTE,     /* '"' */
+    CLASS_COMMA,     /* ',' */
+    CLASS_DOT,       /* '.' */
+    CLASS_COLON,     /* ':' */
+    CLASS_SEMICOLON, /* ';' */
+    CLASS_OTHER,
+    CLASSES_COUNT
+} char_class;
+
+#define E_ CLASS_END
+#define S_ CLASS_SPACE
+#define Q_ CLASS_QUOTE
+#define C_ CLASS_COMMA
+#define D_ CLASS_DOT
+#define L_ CLASS_COLON
+#define M_ CLASS_SEMICOLON
+#define O_ CLASS_OTHER
+
+static const unsigned char char_classes[256] = {
+    E_, O_, O_, O_, O_, O_, O_, O_, O_, S_, S_, S_, S_, S_, O_, O_, /* 0x00 - 0x0f: '\t' '\n' '\v' '\f' '\r' */
+    O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, /* 0x10 - 0x1f */
+    S_, O_, Q_, O_, O_, O_, O_, O_, O_, O_, O_, O_, C_, O_, D_, O_, /* 0x20 - 0x2f: ' ' '"' ',' '.' */
+    O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, L_, M_, O_, O_, O_, O_, /* 0x30 - 0x3f: ':' ';' */
+    O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, /* 0x40 - 0x4f */
+    O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, /* 0x50 - 0x5f */
+    O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, /* 0x60 - 0x6f */
+    O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, /* 0x70 - 0x7f */
+    O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, /* 0x80 - 0xff */
+    O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_,
+    O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_,
+    O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_,
+    O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_,
+    O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_,
+    O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_,
+    O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_, O_
+};
+
+typedef enum e_lexer_state
+{
+    BEFORE_NAME,     /* Whitespaces before the command name */
+    AFTER_DOT,       /* The dot of a directive - the name itself comes next */
+    IN_NAME,
+    BEFORE_OPERANDS, /* Whitespaces after the command name */
+    EXPECT_OPERAND,  /* After a comma */
+    IN_OPERAND,
+    IN_QUOTES,
+    AFTER_QUOTES,    /* Right after the closing quotes */
+    AFTER_OPERAND,   /* Whitespaces after an operand */
+
+    /* The errors. The lexer stays in them. */
+    NO_COMMAND,
+    QUOTES_IN_OPERAND,
+    NO_COMMA_BEFORE_OPERAND,
+    COMMA_AFTER_COMMA,
+    COMMA_AFTER_LAST_OPERAND,
+    UNCLOSED_QUOTES,
+
+    /* The errors of the label. Not states - the label is checked after the line is read. */
+    EMPTY_LABEL,
+    LONG_LABEL,
+    SPACE_BEFORE_COLON
+} lexer_state;
+
+#define FIRST_ERROR NO_COMMAND
+
+/* The next state, by the current state and the class of the char. Colons and semicolons are like any other char -
+ * only the first char and the label care about them. */
+#define NO_COMMA NO_COMMA_BEFORE_OPERAND
+static const unsigned char transitions[FIRST_ERROR][CLASSES_COUNT] = {
+    /*                    END                       SPACE            QUOTE              COMMA              DOT         COLON       SEMICOLON   OTHER */
+    /* BEFORE_NAME */     {NO_COMMAND,               BEFORE_NAME,     IN_NAME,           IN_NAME,           AFTER_DOT,  IN_NAME,    IN_NAME,    IN_NAME},
+    /* AFTER_DOT */       {NO_COMMAND,               NO_COMMAND,      IN_NAME,           IN_NAME,           IN_NAME,    IN_NAME,    IN_NAME,    IN_NAME},
+    /* IN_NAME */         {IN_NAME,                  BEFORE_OPERANDS, IN_NAME,           IN_NAME,           IN_NAME,    IN_NAME,    IN_NAME,    IN_NAME},
+    /* BEFORE_OPERANDS */ {BEFORE_OPERANDS,          BEFORE_OPERANDS, IN_QUOTES,         COMMA_AFTER_COMMA, IN_OPERAND, IN_OPERAND, IN_OPERAND, IN_OPERAND},
+    /* EXPECT_OPERAND */  {COMMA_AFTER_LAST_OPERAND, EXPECT_OPERAND,  IN_QUOTES,         COMMA_AFTER_COMMA, IN_OPERAND, IN_OPERAND, IN_OPERAND, IN_OPERAND},
+    /* IN_OPERAND */      {IN_OPERAND,               AFTER_OPERAND,   QUOTES_IN_OPERAND, EXPECT_OPERAND,    IN_OPERAND, IN_OPERAND, IN_OPERAND, IN_OPERAND},
+    /* IN_QUOTES */       {UNCLOSED_QUOTES,          IN_QUOTES,       AFTER_QUOTES,      IN_QUOTES,         IN_QUOTES,  IN_QUOTES,  IN_QUOTES,  IN_QUOTES},
+    /* AFTER_QUOTES */    {AFTER_QUOTES,             AFTER_OPERAND,   QUOTES_IN_OPERAND, EXPECT_OPERAND,    NO_COMMA,   NO_COMMA,   NO_COMMA,   NO_COMMA},
+    /* AFTER_OPERAND */   {AFTER_OPERAND,            AFTER_OPERAND,   NO_COMMA,          EXPECT_OPERAND,    NO_COMMA,   NO_COMMA,   NO_COMMA,   NO_COMMA}
+};
+#undef NO_COMMA
+
+typedef struct s_syntax_error
+{
+    char *type;            /**< The type of the message. */
+    char *message;         /**< The message. */
+    parser_status status;  /**< What should the parser return? */
+} syntax_error;
+
+/* The errors, in the order of lexer_state (From FIRST_ERROR) */
+static const syntax_error syntax_errors[] = {
+    {SYNTAX_ERROR, "A line must contain a command (For example - addi)", PARSER_SYNTAX_ERROR},
+    {SYNTAX_ERROR, "You cannot open quotes inside of an operand", PARSER_SYNTAX_ERROR},
+    {SYNTAX_ERROR, "There must be a comma before an operand, except the first operand", PARSER_SYNTAX_ERROR},
+    {SYNTAX_ERROR, "There cannot be a comma after a comma", PARSER_SYNTAX_ERROR},
+    {SYNTAX_ERROR, "There souldn't be any comma after the last operand", PARSER_SYNTAX_ERROR},
+    {SYNTAX_ERROR, "You must close your quotes", PARSER_SYNTAX_ERROR},
+    {SYNTAX_ERROR, "A label cannot be empty", PARSER_SYNTAX_ERROR},
+    {OVERFLOW_ERROR, "A label cannot be longer than 31 characters", PARSER_OVERFLOW},
+    {SYNTAX_ERROR, "The colon of the label must be right after the label", PARSER_SYNTAX_ERROR}
+};
+
+typedef struct s_lexer
+{
+    lexer_state state;
+    command_type type;
+    int name_start, name_end;                  /**< The span of the command name in the line, without the dot. */
+    int number_of_operands;                    /**< How many operands ended so far? */
+    int operand_starts[OPERANDS_MAX_COUNT];    /**< The spans of the operands in the line. */
+    int operand_ends[OPERANDS_MAX_COUNT];
+} lexer;
 
-    return false;
+/**
+ * Initializes a lexer, before the command name.
+ * @param lexer_p The lexer.
+ */
+static void lexer_init(lexer *lexer_p)
+{
+    lexer_p->state = BEFORE_NAME;
+    lexer_p->type = INSTRUCTION;
+    lexer_p->number_of_operands = 0;
 }
 
 /**
- * Parses the label in the command. Increments the given string to after the label.
- * @param str     A pointer to the pointer of the string to parse. MUST NOT BE EMPTY OR COMMENT
- * @param command The command object to parse into.
- * @param line    On what line is this string?
- * @return PARSER_SYNTAX_ERROR or PARSER_OVERFLOW or PARSER_OK.
+ * Moves the lexer by the next char of the line.
+ * @param lexer_p The lexer.
+ * @param class   The class of the char. Not CLASS_END.
+ * @param i       The index of the char in the line.
  */
-static parser_status parse_label(char **str, command *cmd, int line)
+static void lexer_step(lexer *lexer_p, char_class class, int i)
 {
-    int label_length;
-
-    if (has_label(*str))
+    lexer_state next;
+
+    if (lexer_p->state >= FIRST_ERROR)
+        return;
+    next = transitions[lexer_p->state][class];
+    if (next == lexer_p->state)
+        return;
+
+    /* Leaving a state - ends the span of the name or of an operand */
+    if (lexer_p->state == IN_NAME)
+        lexer_p->name_end = i;
+    else if (lexer_p->state == IN_OPERAND || lexer_p->state == AFTER_QUOTES)
+        lexer_p->operand_ends[lexer_p->number_of_operands] = i;
+
+    /* Entering a state - starts the span of the name or of an operand */
+    switch (next)
     {
-        skip_whitespaces(str);
-
-        if (**str == ':')
-        {
-            logger_log(PARSER, SYNTAX_ERROR, line, "A label cannot be empty");
-            return PARSER_SYNTAX_ERROR;
-        }
-
-        label_length = 0;
-        while (**str != ':')
-        {
-            label_length++;
-            if (label_length > MAX_LABEL)
-            {
-                logger_log(PARSER, OVERFLOW_ERROR, line, "A label cannot be longer than 31 characters");
-                return PARSER_OVERFLOW;
-            }
-
-            cmd->label[label_length - 1] = **str;
-            (*str)++;
-        }
-
-        if (isspace(*(*str - 1)))
-        {
-            logger_log(PARSER, SYNTAX_ERROR, line, "The colon of the label must be right after the label");
-            return PARSER_SYNTAX_ERROR;
-        }
-
-        cmd->label[label_length] = '\0';
-
-        (*str)++; /* Point to after the label */
+    case AFTER_DOT:
+        lexer_p->type = DIRECTIVE;
+        break;
+    case IN_NAME:
+        lexer_p->name_start = i;
+        break;
+    case IN_OPERAND:
+    case IN_QUOTES:
+        lexer_p->operand_starts[lexer_p->number_of_operands] = i;
+        break;
+    case EXPECT_OPERAND: /* After a comma */
+        lexer_p->number_of_operands++;
+        break;
+    default:
+        break;
     }
-    else
-        cmd->label[0] = '\0';
 
-    return PARSER_OK;
+    lexer_p->state = next;
 }
 
 /**
- * Checks if the command is empty or is a comment.
- * @param str The command.
- * @return if empty.
+ * Moves the lexer by the end of the line.
+ * @param lexer_p The lexer.
+ * @param i       The index of the terminating zero of the line.
  */
-static boolean is_empty(char *str)
+static void lexer_finish(lexer *lexer_p, int i)
 {
-    while (*str)
+    switch (lexer_p->state)
     {
-        if (*str == ';')
-            return true;
-        else if (!isspace(*str))
-            return false;
-
-        str++;
+    case IN_NAME:
+        lexer_p->name_end = i;
+        break;
+    case IN_OPERAND:
+    case AFTER_QUOTES:
+        lexer_p->operand_ends[lexer_p->number_of_operands++] = i;
+        break;
+    case AFTER_OPERAND:
+        lexer_p->number_of_operands++;
+        break;
+    default:
+        break;
     }
 
-    return true;
+    if (lexer_p->state < FIRST_ERROR)
+        lexer_p->state = transitions[lexer_p->state][CLASS_END];
 }
 
 /**
- * Parses the command name in the command. Increments the given string to after the command name.
- * @param str     A pointer to the pointer of the string to parse, STARTING AFTER THE LABEL!
- * @param command The command object to parse into.
- * @param line    On what line is this string?
- * @return PARSER_SYNTAX_ERROR or PARSER_NOT_ENOUGH_MEMORY or PARSER_OK.
+ * Packs the command name and the operands that the lexer found at the start of the line, each with a terminating
+ * zero, and points the command into them. The spans are in order, and there is at least one char between every two,
+ * so the writing never passes the reading.
+ * @param lexer_p  The lexer. Must have no errors.
+ * @param buffer_p The buffer of the line.
+ * @param cmd      The command.
  */
-static parser_status parse_command_name(char **str, command *cmd, int line)
+static void pack_command(lexer *lexer_p, command_buffer *buffer_p, command *cmd)
 {
-    int command_name_length = 0, i;
-    char *ptr;
-
-    skip_whitespaces(str);
-
-    if (**str == '.')
-        cmd->type = DIRECTIVE;
-    else
-        cmd->type = INSTRUCTION;
+    char *out = buffer_p->line;
+    int i, length;
 
-    /* Find the length of the command name */
-    ptr = *str;
-    while (!isspace(*ptr) && *ptr)
-    {
-        command_name_length++;
-        ptr++;
-    }
+    cmd->type = lexer_p->type;
+    cmd->number_of_operands = lexer_p->number_of_operands;
+    cmd->operands = lexer_p->number_of_operands > 0 ? buffer_p->operands : NULL;
+    cmd->values = lexer_p->number_of_operands > 0 ? buffer_p->values : NULL;
 
-    if (cmd->type == DIRECTIVE)
-        command_name_length--; /* I don't want to put the '.' in the command name. */
+    length = lexer_p->name_end - lexer_p->name_start;
+    memmove(out, buffer_p->line + lexer_p->name_start, length);
+    out[length] = '\0';
+    cmd->command_name = out;
+    out += length + 1;
 
-    if (command_name_length == 0)
+    for (i = 0; i < lexer_p->number_of_operands; i++)
     {
-        logger_log(PARSER, SYNTAX_ERROR, line, "A line must contain a command (For example - addi)");
-        return PARSER_SYNTAX_ERROR;
+        length = lexer_p->operand_ends[i] - lexer_p->operand_starts[i];
+        memmove(out, buffer_p->line + lexer_p->operand_starts[i], length);
+        out[length] = '\0';
+        cmd->operands[i] = out;
+        out += length + 1;
     }
-
-    /* Allocate buffer for the command name */
-    cmd->command_name = malloc((command_name_length + 1) * sizeof(char));
-    if (cmd->command_name == NULL)
-        return PARSER_NOT_ENOUGH_MEMORY;
-    cmd->command_name_allocated = true;
-
-    /* Fill! */
-    if (cmd->type == DIRECTIVE)
-        (*str)++; /* Skip the dot if this is a directive. */
-    for (i = 0; i < command_name_length; i++)
-    {
-        cmd->command_name[i] = **str;
-        (*str)++;
-    }
-
-    /* Put terminating zero */
-    cmd->command_name[command_name_length] = '\0';
-
-    return PARSER_OK;
 }
 
-/**
- * Calculates the number of operands in the given string. Reports if there
- * was any syntax error with the operands.
- * @param str  The string to check. MUST BEGIN RIGHT FROM THE OPERANDS.
- *             There must be at least one operand!
- * @param int  A pointer to integer to fill in the number of operands.
- * @param line The line in which the error occurred.
- * @return PARSER_SYNTAX_ERROR or PARSER_OK.
- */
-static parser_status get_number_of_operands(char *str, int *number_of_operands, int line)
+parser_status parser_parse(command_buffer *buffer_p, command *cmd, int line)
 {
-    boolean inside_quotes, inside_operand, after_comma, after_quotes_end;
-
-    *number_of_operands = 0;
-    inside_quotes = false, inside_operand = false, after_comma = true, after_quotes_end = false;
-    while (*str)
+    char *str = buffer_p->line;
+    lexer without_label, with_label, *lexer_p;
+    boolean inside_quotes = false, label_is_possible = false, has_label = false;
+    int i, first_char = -1, first_colon = -1;
+    char_class class;
+
+    lexer_init(&without_label);
+    for (i = 0; (class = (char_class) char_classes[(unsigned char) str[i]]) != CLASS_END; i++)
     {
-        if (*str == '"')
+        if (first_char < 0 && class != CLASS_SPACE)
         {
-            inside_quotes = !inside_quotes;
-
-            if (inside_operand && inside_quotes)
-            {
-                logger_log(PARSER, SYNTAX_ERROR, line, "You cannot open quotes inside of an operand");
-                return PARSER_SYNTAX_ERROR;
-            }
-
-            if (!after_comma || after_quotes_end)
-            {
-                logger_log(PARSER, SYNTAX_ERROR, line, "There must be a comma before an operand, except the first operand");
-                return PARSER_SYNTAX_ERROR;
-            }
-
-            inside_operand = true;
-
-            if (!inside_quotes)
-            {
-                after_quotes_end = true;
-                goto next_iteration; /* This current char doesn't need more parse */
-            }
+            if (class == CLASS_SEMICOLON)
+                return PARSER_EMPTY; /* A comment */
+            first_char = i;
         }
 
-        if (inside_quotes)
-            goto next_iteration; /* There is nothing to parse inside of quotes. */
-
-        if (*str == ',')
-        {
-            if (inside_operand)
-            {
-                inside_operand = false;
-                after_comma = false;
-            }
-
-            if (after_comma && !inside_operand)
-            {
-                logger_log(PARSER, SYNTAX_ERROR, line, "There cannot be a comma after a comma");
-                return PARSER_SYNTAX_ERROR;
-            }
+        if (!has_label)
+            lexer_step(&without_label, class, i);
+        if (label_is_possible)
+            lexer_step(&with_label, class, i);
 
-            (*number_of_operands)++;
-            after_comma = true;
-            inside_operand = false;
-        }
-        else if (!isspace(*str)) /* This is a regular operand */
+        if (class == CLASS_QUOTE)
+            inside_quotes = !inside_quotes;
+        else if (class == CLASS_COLON)
         {
-            if (!after_comma || after_quotes_end)
+            has_label |= !inside_quotes;
+            if (first_colon < 0)
             {
-                logger_log(PARSER, SYNTAX_ERROR, line, "There must be a comma before an operand, except the first operand");
-                return PARSER_SYNTAX_ERROR;
+                first_colon = i;
+                label_is_possible = true;
+                lexer_init(&with_label); /* Reads from the next char */
             }
-
-            inside_operand = true;
         }
-        else /* This is a whitespace */
-        {
-            if (inside_operand)
-                after_comma = false;
-
-            inside_operand = false;
-        }
-
-        /* If it wasn't just now defined. Actually, it's not needed, because after
-        after_quotes_end is setted to true - it jumps to next_iteration, but anyway
-        it is a good practis to put it - for future code change. */
-        if (!inside_quotes)
-            after_quotes_end = false;
-
-    next_iteration:
-        str++;
-    }
-
-    /* If inside_operand is true, it means that I am RIGHT AFTER an operand, so
-    then it's ok if after_comma is true, because It just means that there
-    was a comma before the operand. But if I am not after a operand, and
-    after_comma is true - It is a syntax error, because there shouldn't be 
-    any comma after the last operand. */
-    if (after_comma && !inside_operand)
-    {
-        logger_log(PARSER, SYNTAX_ERROR, line, "There souldn't be any comma after the last operand");
-        return PARSER_SYNTAX_ERROR;
-    }
-
-    if (inside_quotes)
-    {
-        logger_log(PARSER, SYNTAX_ERROR, line, "You must close your quotes");
-        return PARSER_SYNTAX_ERROR;
     }
-    (*number_of_operands)++; /* To count the first operand */
 
-    return PARSER_OK;
-}
-
-/**
- * Fills the operand of the given string in the given array.
- * @param cmd                The current command.
- * @param str                The string to parse. MUST BEGIN RIGHT FROM THE 
- *                           OPERANDS. IT'S SYNTAX MUST BE OK!
- * @return PARSER_NOT_ENOUGH_MEMORY or PARSER_OK;
- */
-static parser_status fill_operands(command* cmd, char *str)
-{
-    int i, j, operand_length;
-    char *ptr, *operand; /* An helping pointer */
-    boolean inside_quotes;
+    if (first_char < 0)
+        return PARSER_EMPTY;
 
-    for (i = 0; i < cmd->number_of_operands; i++)
+    if (has_label)
     {
-        ptr = str; /* Back up the string pointer */
-
-        /* First, calculate the operand size */
-        operand_length = 0;
-        inside_quotes = false;
-        while ((*str != ',' || inside_quotes) && *str)
-        {
-            if (*str == '"')
-                inside_quotes = !inside_quotes;
-
-            if (!isspace(*str) || inside_quotes)
-                operand_length++;
-
-            str++;
-        }
-
-        /* Now, insert the pointer to the array! */
-        /* First, allocate memory for the operand */
-        operand = malloc((operand_length+1) * sizeof(char));
-        if (operand == NULL)
-            return PARSER_NOT_ENOUGH_MEMORY;
-        cmd->number_of_operands_allocated++;
-
-        str = ptr; /* Go back to the beginning of the operand */
-        j = 0;
-        inside_quotes = false;
-        while ((*str != ',' || inside_quotes) && *str)
+        /* The label is everything from the first char to the first colon. It's errors come before the others. */
+        lexer_p = &with_label;
+        if (first_colon == first_char)
+            lexer_p->state = EMPTY_LABEL;
+        else if (first_colon - first_char > MAX_LABEL)
+            lexer_p->state = LONG_LABEL;
+        else if (char_classes[(unsigned char) str[first_colon - 1]] == CLASS_SPACE)
+            lexer_p->state = SPACE_BEFORE_COLON;
+        else
         {
-            if (*str == '"')
-                inside_quotes = !inside_quotes;
-
-            if (!isspace(*str) || inside_quotes)
-            {
-                operand[j] = *str;
-                j++;
-            }
-
-            str++;
+            memcpy(cmd->label, str + first_char, first_colon - first_char);
+            cmd->label[first_colon - first_char] = '\0';
         }
-        operand[j] = '\0';
-
-        cmd->operands[i] = operand;
-
-        if (*str)
-            str++; /* To skip the comma */
     }
-
-    return PARSER_OK;
-}
-
-/**
- * Parses the operands in the command.
- * @param str     A pointer to the string to parse.
- * @param command The command object to parse into, STARTING FROM THE OPERANDS!
- * @param line    On what line is this string?
- * @return PARSER_SYNTAX_ERROR or PARSER_NOT_ENOUGH_MEMORY or PARSER_OK.
- */
-static parser_status parse_operands(char *str, command *cmd, int line)
-{
-    parser_status status;
-
-    skip_whitespaces(&str);
-    if (!*str) /* There are no operands.. */
+    else
     {
-        cmd->number_of_operands = 0;
-        cmd->operands = NULL;
-        return PARSER_OK;
+        lexer_p = &without_label;
+        cmd->label[0] = '\0';
     }
 
-    /* Get the number of operands */
-    if ((status = get_number_of_operands(str, &cmd->number_of_operands, line)) != PARSER_OK)
-        return status;
-
-    /* Allocate the array of the operands */
-    cmd->operands = malloc(cmd->number_of_operands * sizeof(char *));
-    if (cmd->operands == NULL)
-        return PARSER_NOT_ENOUGH_MEMORY;
-    cmd->operands_array_allocated = true;
-
-    /* Fill the operands in the array */
-    if ((status = fill_operands(cmd, str)) != PARSER_OK)
-        return status;
-
-    return PARSER_OK;
-}
-
-parser_status parser_parse(char *str, command *cmd, int line)
-{
-    parser_status status;
-
-    cmd->command_name_allocated = false;
-    cmd->operands_array_allocated = false;
-    cmd->number_of_operands_allocated = 0;
-
-    if (is_empty(str))
-        return PARSER_EMPTY;
-    if ((status = parse_label(&str, cmd, line)) != PARSER_OK)
-        return status;
-    if ((status = parse_command_name(&str, cmd, line)) != PARSER_OK)
-        return status;
-    if ((status = parse_operands(str, cmd, line)) != PARSER_OK)
-        return status;
+    lexer_finish(lexer_p, i);
+    if (lexer_p->state >= FIRST_ERROR)
+    {
+        const syntax_error *error_p = &syntax_errors[lexer_p->state - FIRST_ERROR];
+        logger_log(PARSER, error_p->type, line, "%s", error_p->message);
+        return error_p->status;
+    }
 
+    pack_command(lexer_p, buffer_p, cmd);
     return PARSER_OK;
 }
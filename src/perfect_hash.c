@@ -0,0 +1,28 @@
+#include "perfect_hash.h"
+
+#define FNV_PRIME 16777619UL
+#define HASH_MASK 0xFFFFFFFFUL /* Keep the hashes 32 bit, so they are the same on every platform */
+
+void perfect_hash_string(char *str, unsigned long seed1, unsigned long seed2, unsigned long *h1, unsigned long *h2)
+{
+    unsigned long hash1 = seed1, hash2 = seed2;
+
+    while (*str)
+    {
+        unsigned char c = (unsigned char) *str++;
+        hash1 = ((hash1 ^ c) * FNV_PRIME) & HASH_MASK;
+        hash2 = ((hash2 ^ c) * FNV_PRIME) & HASH_MASK;
+    }
+
+    *h1 = hash1;
+    *h2 = hash2;
+}
+
+int perfect_hash_index(const perfect_hash_table *table, char *str)
+{
+    unsigned long h1, h2;
+
+    perfect_hash_string(str, table->seed1, table->seed2, &h1, &h2);
+
+    return (int) ((table->g[h1 % table->vertices] + table->g[h2 % table->vertices]) % table->keys);
+}
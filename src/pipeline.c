@@ -0,0 +1,241 @@
+#define _POSIX_C_SOURCE 200112L /* For pthread */
+
+#include "pipeline.h"
+#include "walk.h"
+#include "command.h"
+#include "logger.h"
+#include "ring_buffer.h"
+#include "boolean.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct s_line_item
+{
+    walk_status status;               /**< What read_next_line() returned. */
+    char line[LINE_MAX_LENGTH + 1];   /**< The line. */
+} line_item;
+
+typedef enum e_command_item_type
+{
+    COMMAND_ITEM,
+    MESSAGE_ITEM,
+    PROBLEM_ITEM,
+    NOT_ENOUGH_MEMORY_ITEM,
+    EOF_ITEM
+} command_item_type;
+
+typedef struct s_command_item
+{
+    command_item_type type; /**< What is this item? */
+    int line;               /**< The line of the command (Or of the message). */
+    command cmd;            /**< The command. ONLY FOR COMMAND_ITEM. */
+    char text[LINE_MAX_LENGTH + 1]; /**< ONLY FOR COMMAND_ITEM: The command name and the operands, packed. */
+    long values[OPERANDS_MAX_COUNT]; /**< ONLY FOR COMMAND_ITEM: The values of the operands. */
+    char *module;           /**< ONLY FOR MESSAGE_ITEM: The module of the message. NULL if it does not belong to a line. */
+    char *message_type;     /**< ONLY FOR MESSAGE_ITEM: The type of the message. */
+    char *message;          /**< ONLY FOR MESSAGE_ITEM: The formatted message. Allocated by malloc(). */
+} command_item;
+
+/**
+ * @brief The reader stage - reads the lines of the source, until it's end.
+ *
+ * @param arg A pointer to the pipeline.
+ * @return void* NULL.
+ */
+static void *read_lines(void *arg)
+{
+    pipeline *pipeline_p = arg;
+    line_item item;
+
+    do
+    {
+        item.status = read_next_line(pipeline_p->source, item.line);
+    } while (ring_buffer_push(&pipeline_p->lines, &item) && item.status != WALK_EOF);
+
+    return NULL;
+}
+
+/**
+ * @brief The logger handler of the parser stage - passes the message to the walk.
+ *
+ * @param context A pointer to the pipeline.
+ * @param module  The module that logged the message.
+ * @param type    The type of the message.
+ * @param line    The line of the message.
+ * @param message The formatted message.
+ */
+static void pass_message(void *context, char *module, char *type, int line, char *message)
+{
+    pipeline *pipeline_p = context;
+    command_item item;
+    size_t message_size = strlen(message) + 1;
+
+    item.message = malloc(message_size);
+    if (!item.message)
+    {
+        pipeline_p->out_of_memory = true;
+        return;
+    }
+    memcpy(item.message, message, message_size);
+    item.type = MESSAGE_ITEM;
+    item.line = line;
+    item.module = module;
+    item.message_type = type;
+
+    if (!ring_buffer_push(&pipeline_p->commands, &item))
+        free(item.message);
+}
+
+/**
+ * @brief The parser stage - parses and validates the lines of the reader, until the end of the source.
+ *
+ * @param arg A pointer to the pipeline.
+ * @return void* NULL.
+ */
+static void *parse_lines(void *arg)
+{
+    pipeline *pipeline_p = arg;
+    line_item line;
+    command_buffer buffer;
+    command_item item;
+    walk_status status;
+    int line_number = 0;
+    logger_sink sink;
+
+    sink.stream = NULL;
+    sink.handler = pass_message;
+    sink.context = pipeline_p;
+    logger_redirect(&sink);
+
+    while (ring_buffer_pop(&pipeline_p->lines, &line))
+    {
+        item.line = ++line_number;
+        if (line.status == WALK_EOF)
+        {
+            item.type = EOF_ITEM;
+            ring_buffer_push(&pipeline_p->commands, &item);
+            break;
+        }
+
+        memcpy(buffer.line, line.line, sizeof(buffer.line));
+        status = parse_line(&buffer, line.status, &item.cmd, line_number, true);
+        if (status == WALK_EMPTY_LINE)
+            continue;
+
+        if (pipeline_p->out_of_memory)
+            status = WALK_NOT_ENOUGH_MEMORY;
+
+        item.type = (status == WALK_OK) ? COMMAND_ITEM : (status == WALK_PROBLEM_WITH_CODE) ? PROBLEM_ITEM : NOT_ENOUGH_MEMORY_ITEM;
+        if (status == WALK_OK) /* The walk links the command to it's own copy of the text and of the values */
+        {
+            memcpy(item.text, buffer.line, sizeof(item.text));
+            memcpy(item.values, buffer.values, item.cmd.number_of_operands * sizeof(long));
+        }
+        if (!ring_buffer_push(&pipeline_p->commands, &item) || status == WALK_NOT_ENOUGH_MEMORY)
+            break;
+    }
+
+    /* The reader has nobody to read for anymore */
+    ring_buffer_close(&pipeline_p->lines);
+    logger_redirect(NULL);
+    return NULL;
+}
+
+pipeline_status pipeline_start(pipeline *pipeline_p, source_file *source)
+{
+    source_file_rewind(source);
+    pipeline_p->source = source;
+    pipeline_p->reader_started = pipeline_p->parser_started = false;
+    pipeline_p->out_of_memory = false;
+    pipeline_p->done = false;
+
+    if (ring_buffer_init(&pipeline_p->lines, sizeof(line_item), PIPELINE_LINES_CAPACITY) != RING_BUFFER_OK)
+        return PIPELINE_NOT_ENOUGH_MEMORY;
+    if (ring_buffer_init(&pipeline_p->commands, sizeof(command_item), PIPELINE_COMMANDS_CAPACITY) != RING_BUFFER_OK)
+    {
+        ring_buffer_free(&pipeline_p->lines);
+        return PIPELINE_NOT_ENOUGH_MEMORY;
+    }
+
+    pipeline_p->reader_started = pthread_create(&pipeline_p->reader, NULL, read_lines, pipeline_p) == 0;
+    pipeline_p->parser_started = pthread_create(&pipeline_p->parser, NULL, parse_lines, pipeline_p) == 0;
+    if (!pipeline_p->reader_started || !pipeline_p->parser_started)
+    {
+        pipeline_stop(pipeline_p, NULL);
+        return PIPELINE_NOT_ENOUGH_MEMORY;
+    }
+
+    return PIPELINE_OK;
+}
+
+walk_status pipeline_next_command(pipeline *pipeline_p, command *cmd, int *line_number)
+{
+    command_item item;
+
+    if (pipeline_p->done)
+        return WALK_EOF;
+
+    while (ring_buffer_pop(&pipeline_p->commands, &item))
+    {
+        *line_number = item.line;
+        switch (item.type)
+        {
+        case MESSAGE_ITEM:
+            if (item.module)
+                logger_log(item.module, item.message_type, item.line, "%s", item.message);
+            else
+                logger_print("%s", item.message);
+            free(item.message);
+            break;
+        case COMMAND_ITEM:
+            memcpy(pipeline_p->buffer.line, item.text, sizeof(item.text));
+            memcpy(pipeline_p->buffer.values, item.values, item.cmd.number_of_operands * sizeof(long));
+            *cmd = item.cmd;
+            command_link(cmd, &pipeline_p->buffer);
+            return WALK_OK;
+        case PROBLEM_ITEM:
+            return WALK_PROBLEM_WITH_CODE;
+        case NOT_ENOUGH_MEMORY_ITEM:
+            pipeline_p->done = true;
+            return WALK_NOT_ENOUGH_MEMORY;
+        default: /* EOF_ITEM */
+            pipeline_p->done = true;
+            return WALK_EOF;
+        }
+    }
+
+    /* The parser stopped without telling why */
+    pipeline_p->done = true;
+    return WALK_NOT_ENOUGH_MEMORY;
+}
+
+void pipeline_stop(pipeline *pipeline_p, pipeline_stats *stats_p)
+{
+    command_item item;
+
+    /* Stop the stages, even if they are in the middle */
+    ring_buffer_close(&pipeline_p->lines);
+    ring_buffer_close(&pipeline_p->commands);
+    if (pipeline_p->reader_started)
+        pthread_join(pipeline_p->reader, NULL);
+    if (pipeline_p->parser_started)
+        pthread_join(pipeline_p->parser, NULL);
+
+    /* Free what the walk did not take */
+    while (ring_buffer_pop(&pipeline_p->commands, &item))
+    {
+        if (item.type == MESSAGE_ITEM)
+            free(item.message);
+    }
+
+    if (stats_p)
+    {
+        ring_buffer_get_stats(&pipeline_p->lines, &stats_p->lines);
+        ring_buffer_get_stats(&pipeline_p->commands, &stats_p->commands);
+    }
+
+    ring_buffer_free(&pipeline_p->lines);
+    ring_buffer_free(&pipeline_p->commands);
+    pipeline_p->reader_started = pipeline_p->parser_started = false;
+}
@@ -0,0 +1,112 @@
+#define _POSIX_C_SOURCE 200112L /* For sched_yield() */
+
+#include "ring_buffer.h"
+#include "boolean.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+
+#define SPIN_LIMIT 128 /* How many times to check before yielding the processor */
+
+#define LOAD_ACQUIRE(p)     __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define STORE_RELEASE(p, v) __atomic_store_n(p, v, __ATOMIC_RELEASE)
+
+ring_buffer_status ring_buffer_init(ring_buffer *ring_p, size_t item_size, unsigned long capacity)
+{
+    ring_p->items = malloc(item_size * capacity);
+    if (!ring_p->items)
+        return RING_BUFFER_NOT_ENOUGH_MEMORY;
+
+    ring_p->item_size = item_size;
+    ring_p->capacity = capacity;
+    ring_p->closed = 0;
+    ring_p->head = ring_p->tail = 0;
+    ring_p->max_depth = ring_p->producer_stalls = ring_p->consumer_stalls = 0;
+
+    return RING_BUFFER_OK;
+}
+
+/**
+ * @brief Waits a little - spins for the first SPIN_LIMIT rounds, and then yields the processor.
+ *
+ * @param round_p A pointer to how many rounds were already waited. It is advanced.
+ */
+static void wait_a_little(int *round_p)
+{
+    if (*round_p < SPIN_LIMIT)
+        (*round_p)++;
+    else
+        sched_yield();
+}
+
+boolean ring_buffer_push(ring_buffer *ring_p, void *item)
+{
+    unsigned long tail = ring_p->tail, depth;
+    int round = 0;
+
+    /* Wait for a free slot */
+    if (tail - LOAD_ACQUIRE(&ring_p->head) == ring_p->capacity)
+    {
+        ring_p->producer_stalls++;
+        while (tail - LOAD_ACQUIRE(&ring_p->head) == ring_p->capacity)
+        {
+            if (LOAD_ACQUIRE(&ring_p->closed))
+                return false;
+            wait_a_little(&round);
+        }
+    }
+    if (LOAD_ACQUIRE(&ring_p->closed))
+        return false;
+
+    memcpy(ring_p->items + (tail & (ring_p->capacity - 1)) * ring_p->item_size, item, ring_p->item_size);
+    STORE_RELEASE(&ring_p->tail, tail + 1);
+
+    depth = tail + 1 - LOAD_ACQUIRE(&ring_p->head);
+    if (depth > ring_p->max_depth)
+        ring_p->max_depth = depth;
+
+    return true;
+}
+
+boolean ring_buffer_pop(ring_buffer *ring_p, void *item)
+{
+    unsigned long head = ring_p->head;
+    int round = 0;
+
+    /* Wait for an item */
+    if (LOAD_ACQUIRE(&ring_p->tail) == head)
+    {
+        ring_p->consumer_stalls++;
+        while (LOAD_ACQUIRE(&ring_p->tail) == head)
+        {
+            if (LOAD_ACQUIRE(&ring_p->closed) && LOAD_ACQUIRE(&ring_p->tail) == head)
+                return false;
+            wait_a_little(&round);
+        }
+    }
+
+    memcpy(item, ring_p->items + (head & (ring_p->capacity - 1)) * ring_p->item_size, ring_p->item_size);
+    STORE_RELEASE(&ring_p->head, head + 1);
+
+    return true;
+}
+
+void ring_buffer_close(ring_buffer *ring_p)
+{
+    STORE_RELEASE(&ring_p->closed, 1);
+}
+
+void ring_buffer_get_stats(ring_buffer *ring_p, ring_buffer_stats *stats_p)
+{
+    stats_p->items = ring_p->tail;
+    stats_p->max_depth = ring_p->max_depth;
+    stats_p->producer_stalls = ring_p->producer_stalls;
+    stats_p->consumer_stalls = ring_p->consumer_stalls;
+}
+
+void ring_buffer_free(ring_buffer *ring_p)
+{
+    free(ring_p->items);
+    ring_p->items = NULL;
+}
@@ -1,56 +1,61 @@
+#define _POSIX_C_SOURCE 200112L /* For pthread */
+
 #include "boolean.h"
 #include "second_walk.h"
-#include "linked_list.h"
 #include "walk.h"
 #include "command.h"
 #include "logger.h"
 #include "symbol.h"
+#include "symbols_table.h"
 #include "translator.h"
 #include "instructions_table.h"
 #include "utils.h"
+#include "arena.h"
+#include "ir.h"
 
 #include <stdlib.h>
-#include <stdio.h>
 #include <string.h>
+#include <pthread.h>
 
 #define SECOND_WALK "SecondWalk"
 #define PROBLEM_WITH_CODE "ProblemWithCode"
 
-#define BUFFER_MIN_SIZE 2048
-
 #define J_INSTRUCTIONS_LABEL_OPERAND_INDEX 0
 
-/* Extends the buffer and it's max_size var, returns WALK_NOT_ENOUGH_MEMORY if it happens. */
-#define REALLOC(buffer, current_size, max_size)                       \
-    {                                                                 \
-        (buffer) = realloc((buffer), current_size + BUFFER_MIN_SIZE); \
-        if (!buffer)                                                  \
-            return WALK_NOT_ENOUGH_MEMORY;                            \
-        (max_size) += BUFFER_MIN_SIZE;                                \
-    }
+#define MIN_INSTRUCTIONS_PER_THREAD    16384 /* Less instructions are not worth a thread */
+#define RANGE_EXTERN_USES_MIN_CAPACITY 64 /* A range keeps the uses of all the externs, so it starts bigger than a symbol */
 
-static int code_image_max_size;
-static int data_image_max_size;
+typedef struct s_extern_use
+{
+    symbol *symbol_p;  /**< The extern symbol. */
+    unsigned long ic;  /**< The address of the instruction that uses it. */
+} extern_use;
 
-/**
- * @brief Handles the given "entry" directive.
- * 
- * @param cmd             The "entry" directive. MUST BE VALIDATED.
- * @param symbols_table_p A pointer to the symbols table.
- * @param line            On what line is this label?
- * @return walk_status WALK_PROBLEM_WITH_CODE or WALK_NOT_ENOUGH_MEMORY or WALK_OK
- */
-static walk_status handle_entry_directive(command cmd, symbols_table *symbols_table_p, int line)
+typedef struct s_encoding_range
+{
+    ir_instructions *instructions_p; /**< The decoded instructions of the IR. */
+    unsigned long first, end;        /**< The range of the instructions to encode - [first, end). */
+    symbols_table st;                /**< The symbols table. It is only read. */
+    unsigned char *code_image;       /**< The code image. Every instruction is put in it's own slot. */
+    arena arena;                     /**< The range's own arena, for the extern uses. */
+    extern_use *extern_uses;         /**< The extern uses of the range, in ascending address order. */
+    unsigned long extern_uses_count;
+    unsigned long extern_uses_capacity;
+    unsigned long first_failure;     /**< The index of the first instruction that could not be encoded, or end. */
+    boolean out_of_memory;
+} encoding_range;
+
+walk_status handle_entry_directive(char *label, symbols_table st, int line)
 {
-    symbol *symbol_p = find_symbol(cmd.operands[0], *symbols_table_p);
+    symbol *symbol_p = symbols_table_find(st, label);
     if (!symbol_p)
     {
-        logger_log(SECOND_WALK, PROBLEM_WITH_CODE, line, "Cannot mark label \"%s\" as entry, because it does not exist", cmd.operands[0]);
+        logger_log(SECOND_WALK, PROBLEM_WITH_CODE, line, "Cannot mark label \"%s\" as entry, because it does not exist", label);
         return WALK_PROBLEM_WITH_CODE;
     }
     if (symbol_p->type == EXTERNAL)
     {
-        logger_log(SECOND_WALK, PROBLEM_WITH_CODE, line, "Cannot mark label \"%s\" as entry, because it defined external", cmd.operands[0]);
+        logger_log(SECOND_WALK, PROBLEM_WITH_CODE, line, "Cannot mark label \"%s\" as entry, because it defined external", label);
         return WALK_PROBLEM_WITH_CODE;
     }
     symbol_p->is_entry = true;
@@ -58,70 +63,69 @@ static walk_status handle_entry_directive(command cmd, symbols_table *symbols_ta
     return WALK_OK;
 }
 
-/**
- * @brief Handles the given "define" directive. ('db' or 'dh' or 'dw').
- *  
- * @param cmd          The "define" directive. MUST BE VALIDATED.
- * @param data_image   A pointer to where to put the address of the data image, already containing a data image.
- * @param dc_p         A pointer to the DCF.
- * @return walk_status WALK_NOT_ENOUGH_MEMORY or WALK_OK
- */
-walk_status handle_define_directive(command cmd, unsigned char **data_image, unsigned long *dc_p)
+walk_status handle_define_directive(ir_record *record, image *data_image_p, unsigned long *dc_p, arena *arena_p)
 {
-    int size, i;
-    switch (cmd.command_name[1]) /* 'b' for byte, 'h' for half, 'w' for word */
+    int size;
+    unsigned long index; /* The index in the content of the image - the runs before are not in it */
+    switch (record->dir->id)
     {
-    case 'b':
+    case DIRECTIVE_DB:
         size = BYTE;
         break;
-    case 'h':
+    case DIRECTIVE_DH:
         size = HALF;
         break;
-    case 'w':
+    case DIRECTIVE_DW:
         size = WORD;
         break;
     default: /* Will never happen */
         break;
     }
 
-    /* Make sure that the buffer is big enough */
-    while (*dc_p + size * cmd.number_of_operands > data_image_max_size)
-        REALLOC(*data_image, *dc_p, data_image_max_size)
+    /* Make sure that the image is big enough */
+    index = *dc_p - data_image_p->runs_size;
+    if (image_reserve(data_image_p, index + size * record->number_of_operands, arena_p) != WALK_OK)
+        return WALK_NOT_ENOUGH_MEMORY;
 
-    /* Do each operand */
-    for (i = 0; i < cmd.number_of_operands; i++)
-    {
-        char *operand = cmd.operands[i];
-        long num = strtol(operand, 0, 10);
-        put_in_char_array(*data_image, num, size, *dc_p);
-
-        *dc_p += size;
-    }
+    /* The validator already converted the operands - they are stored as they are */
+    put_numbers_in_char_array(data_image_p->content + index, record->values, record->number_of_operands, size);
+    *dc_p += size * record->number_of_operands;
 
     return WALK_OK;
 }
 
-/**
- * @brief Handles the given "asciz" directive.
- *  
- * @param cmd          The "asciz" directive. MUST BE VALIDATED.
- * @param data_image   A pointer to where to put the address of the data image, already containing a data image.
- * @param dc_p         A pointer to the DCF.
- * @return walk_status WALK_NOT_ENOUGH_MEMORY or WALK_OK
- */
-walk_status handle_asciz_directive(command cmd, unsigned char **data_image, unsigned long *dc_p)
+walk_status handle_asciz_directive(ir_record *record, image *data_image_p, unsigned long *dc_p, arena *arena_p)
 {
-    size_t count = strlen(cmd.operands[0]) - 2; /* Dont include the quotes */
-    int i;
+    size_t count = strlen(record->operands[0]) - 2; /* Dont include the quotes */
+    unsigned long index = *dc_p - data_image_p->runs_size; /* The index in the content of the image */
 
-    /* Is the buffer big enough? */
-    while (*dc_p + count > data_image_max_size)
-        REALLOC(*data_image, *dc_p, data_image_max_size)
+    /* Is the image big enough? (+1 for the null terminator) */
+    if (image_reserve(data_image_p, index + count + 1, arena_p) != WALK_OK)
+        return WALK_NOT_ENOUGH_MEMORY;
+
+    memcpy(data_image_p->content + index, record->operands[0] + 1, count); /* +1 Because [0] contains the first quote. */
+    data_image_p->content[index + count] = '\0';
+    *dc_p += count + 1;
 
-    for (i = 0; i < count; i++)
-        (*data_image)[(*dc_p)++] = (unsigned char)cmd.operands[0][i + 1]; /* +1 Because [0] contains the first quote. */
+    return WALK_OK;
+}
+
+walk_status handle_run_directive(ir_record *record, image *data_image_p, unsigned long *dc_p, arena *arena_p)
+{
+    unsigned long count = (unsigned long) record->values[0];
+    long value = 0;
+    int size = BYTE;
+
+    if (record->dir->id == DIRECTIVE_FILL)
+    {
+        value = record->values[1];
+        size = (int) record->values[2];
+    }
 
-    (*data_image)[(*dc_p)++] = '\0';
+    /* Only the run itself is kept - the content of the image does not grow */
+    if (count > 0 && image_add_run(data_image_p, *dc_p, count, value, size, arena_p) != WALK_OK)
+        return WALK_NOT_ENOUGH_MEMORY;
+    *dc_p += count * size;
 
     return WALK_OK;
 }
@@ -129,87 +133,82 @@ walk_status handle_asciz_directive(command cmd, unsigned char **data_image, unsi
 /**
  * @brief Handles the given directive.
  * 
- * @param cmd             The directive. MUST BE VALIDATED.
- * @param data_image      A pointer to where to put the address of the data image.
+ * @param record          The directive. MUST BE VALIDATED.
+ * @param data_image_p    A pointer to the data image.
  * @param dc_p            A pointer to the DC.
  * @param symbols_table_p A pointer to the symbols table.
- * @param line            On what line is this label?
+ * @param arena_p         The compilation's arena.
  * @return walk_status    WALK_PROBLEM_WITH_CODE or WALK_NOT_ENOUGH_MEMORY or WALK_OK
  */
-static walk_status handle_directive(command cmd, unsigned char **data_image, unsigned long *dc_p, symbols_table *symbols_table_p, int line)
+static walk_status handle_directive(ir_record *record, image *data_image_p, unsigned long *dc_p, symbols_table *symbols_table_p, arena *arena_p)
 {
-    if (strcmp(cmd.command_name, "entry") == 0)
-        return handle_entry_directive(cmd, symbols_table_p, line);
-    else if (*cmd.command_name == 'd') /* 'db' or 'dh' or 'dw'. */
-        return handle_define_directive(cmd, data_image, dc_p);
-    else if (strcmp(cmd.command_name, "asciz") == 0)
-        return handle_asciz_directive(cmd, data_image, dc_p);
-    else if (strcmp(cmd.command_name, "extern") == 0)
-        return WALK_OK; /* There is nothing to do; The first walk already treated this case */
-
-    return WALK_OK;
+    switch (record->dir->id)
+    {
+    case DIRECTIVE_ENTRY:
+        return handle_entry_directive(record->operands[0], *symbols_table_p, record->line);
+    case DIRECTIVE_DB:
+    case DIRECTIVE_DH:
+    case DIRECTIVE_DW:
+        return handle_define_directive(record, data_image_p, dc_p, arena_p);
+    case DIRECTIVE_ASCIZ:
+        return handle_asciz_directive(record, data_image_p, dc_p, arena_p);
+    case DIRECTIVE_SPACE:
+    case DIRECTIVE_FILL:
+        return handle_run_directive(record, data_image_p, dc_p, arena_p);
+    default: /* .extern - there is nothing to do; The first walk already treated this case */
+        return WALK_OK;
+    }
 }
 
 /**
  * @brief Adds the given command to the externs table in the symbols table,
  *        if it uses an extern label, and if the instruction type is J.
  * 
- * @param cmd          The command. MUST BE VALIDATED, and must pass a translation.
+ * @param record       The command. MUST BE VALIDATED, and must pass a translation.
  * @param ic           Current IC.
  * @param st           The symbol table.
+ * @param arena_p      The arena to allocate the extern uses from.
  * @return walk_status WALK_NOT_ENOUGH_MEMORY or WALK_PROBLEM_WITH_CODE or WALK_OK.
  */
-walk_status add_instruction_to_externs_table(command cmd, unsigned long ic, symbols_table st)
+walk_status add_instruction_to_externs_table(ir_record *record, unsigned long ic, symbols_table st, arena *arena_p)
 {
-    instruction *inst;
     char *label_name;
     symbol *symbol_p;
-    unsigned long *value_p;
-
-    instructions_table_get_instruction(cmd.command_name, &inst);
 
     /* Is it J? */
-    if (inst->type != J)
+    if (record->inst->type != J)
         return WALK_OK;
 
     /* Ok, it is J. The only J instruction that does not use a label is "stop". */
-    if (strcmp(cmd.command_name, "stop") == 0)
+    if (record->inst->id == INSTRUCTION_STOP)
         return WALK_OK;
 
-    label_name = cmd.operands[J_INSTRUCTIONS_LABEL_OPERAND_INDEX];
+    label_name = record->operands[J_INSTRUCTIONS_LABEL_OPERAND_INDEX];
 
     /* JMP instruction can take a register instead. Make sure that this is not a register. */
     if (label_name[0] == '$')
         return WALK_OK;
 
     /* Make sure that the label is extern. */
-    symbol_p = find_symbol(label_name, st); /* The label surely exist, because it passed translation */
+    symbol_p = symbols_table_find(st, label_name); /* The label surely exist, because it passed translation */
     if (symbol_p->type != EXTERNAL)
         return WALK_OK;
 
     /* Ok, we have to add it! */
-    value_p = malloc(sizeof(unsigned long));
-    *value_p = ic;
-    if (linked_list_append(&symbol_p->instructions_using_me, value_p) == LINKED_LIST_NOT_ENOUGH_MEMORY)
-    {
-        free(value_p);
-        return WALK_NOT_ENOUGH_MEMORY;
-    }
-
-    return WALK_OK;
+    return add_extern_use(symbol_p, ic, arena_p);
 }
 
 /**
  * @brief Handles the given instruction.
  * 
- * @param cmd          The directive. MUST BE VALIDATED.
+ * @param record       The instruction. MUST BE VALIDATED.
  * @param st           The symbols table.
- * @param code_image   A pointer to where to put the address of the code image.
- * @param dc_p         A pointer to the DC.
- * @param line         On what line this instruction is?
+ * @param code_image_p A pointer to the code image.
+ * @param ic_p         A pointer to the IC.
+ * @param arena_p      The compilation's arena.
  * @return walk_status WALK_NOT_ENOUGH_MEMORY or WALK_PROBLEM_WITH_CODE or WALK_OK.
  */
-walk_status handle_instruction(command cmd, symbols_table st, unsigned char **code_image, unsigned long *ic_p, int line)
+static walk_status handle_instruction(ir_record *record, symbols_table st, image *code_image_p, unsigned long *ic_p, arena *arena_p)
 {
     machine_instruction m;
     walk_status status;
@@ -218,75 +217,255 @@ walk_status handle_instruction(command cmd, symbols_table st, unsigned char **co
 
     index = *ic_p - IC_DEFAULT_VALUE;
 
-    t_status = translator_translate(cmd, st, *ic_p, line, &m);
+    t_status = translator_translate(record, st, *ic_p, &m);
     if (t_status != TRANSLATOR_OK)
         return WALK_PROBLEM_WITH_CODE; /* Do not need to log; The translator already logged. */
 
-    /* Is the buffer big enough? */
-    while (index + sizeof(machine_instruction) > code_image_max_size)
-        REALLOC(*code_image, index, code_image_max_size)
+    /* Is the image big enough? */
+    if (image_reserve(code_image_p, index + INSTRUCTION_SIZE, arena_p) != WALK_OK)
+        return WALK_NOT_ENOUGH_MEMORY;
 
-    ((machine_instruction *)(*code_image))[index / sizeof(machine_instruction)] = m;
-    status = add_instruction_to_externs_table(cmd, *ic_p, st);
+    translator_store(code_image_p->content, index, m);
+    status = add_instruction_to_externs_table(record, *ic_p, st, arena_p);
     *ic_p += INSTRUCTION_SIZE;
 
     return status;
 }
 
-walk_status second_walk(char *file_name, symbols_table *symbols_table_p, unsigned char **data_image, unsigned long *dcf_p, unsigned char **code_image, unsigned long *icf_p)
+/**
+ * @brief Finds the first use of a label by the given instruction, or by an instruction after it.
+ *
+ * @param instructions_p The decoded instructions.
+ * @param index          The index of the instruction.
+ * @return unsigned long The index of the use, or label_uses_count if there is none.
+ */
+static unsigned long first_label_use(ir_instructions *instructions_p, unsigned long index)
 {
-    FILE *file;
-    command cmd;
-    int line_number = 0;
+    unsigned long low = 0, high = instructions_p->label_uses_count, middle;
+
+    while (low < high) /* The uses are in the order of the instructions */
+    {
+        middle = low + (high - low) / 2;
+        if (instructions_p->label_uses[middle].index < index)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    return low;
+}
+
+/**
+ * @brief Records that the instruction at <ic> uses the given extern symbol, in the extern uses of the given range -
+ *        like add_extern_use() does for the symbol.
+ *
+ * @param range_p      The range.
+ * @param symbol_p     The extern symbol.
+ * @param ic           The address of the instruction.
+ * @return walk_status WALK_NOT_ENOUGH_MEMORY or WALK_OK.
+ */
+static walk_status add_range_extern_use(encoding_range *range_p, symbol *symbol_p, unsigned long ic)
+{
+    if (range_p->extern_uses_count == range_p->extern_uses_capacity)
+    {
+        unsigned long new_capacity = range_p->extern_uses_capacity * 2;
+        extern_use *new_uses;
+
+        if (new_capacity < RANGE_EXTERN_USES_MIN_CAPACITY)
+            new_capacity = RANGE_EXTERN_USES_MIN_CAPACITY;
+
+        new_uses = arena_realloc(&range_p->arena, range_p->extern_uses,
+                                 range_p->extern_uses_capacity * sizeof(extern_use),
+                                 new_capacity * sizeof(extern_use));
+        if (!new_uses)
+            return WALK_NOT_ENOUGH_MEMORY;
+
+        range_p->extern_uses = new_uses;
+        range_p->extern_uses_capacity = new_capacity;
+    }
+
+    range_p->extern_uses[range_p->extern_uses_count].symbol_p = symbol_p;
+    range_p->extern_uses[range_p->extern_uses_count++].ic = ic;
+    return WALK_OK;
+}
+
+/**
+ * @brief Encodes a range of the decoded instructions, at the addresses of the first walk: All of them at once, and
+ *        then the labels that they use, in order. Keeps their extern uses. Stops (Without logging) at the first label
+ *        that cannot be put - from there the addresses are not the addresses of the first walk anymore. May run on
+ *        it's own thread.
+ *
+ * @param arg A pointer to the range.
+ * @return void* NULL.
+ */
+static void *encode_range(void *arg)
+{
+    encoding_range *range_p = arg;
+    ir_instructions *instructions_p = range_p->instructions_p;
+    unsigned long i, index;
+    machine_instruction m;
+    symbol *symbol_p;
+    ir_label_use *use_p;
+
+    translator_encode(instructions_p, range_p->first, range_p->end, range_p->code_image);
+
+    range_p->first_failure = range_p->end;
+    for (i = first_label_use(instructions_p, range_p->first); i < instructions_p->label_uses_count && instructions_p->label_uses[i].index < range_p->end; i++)
+    {
+        use_p = &instructions_p->label_uses[i];
+        index = use_p->index * INSTRUCTION_SIZE;
+
+        symbol_p = symbols_table_find(range_p->st, use_p->label);
+        m = translator_load(range_p->code_image, index);
+        if (translator_put_label(&m, use_p->type, use_p->label, symbol_p, IC_DEFAULT_VALUE + index, 0, false) != TRANSLATOR_OK)
+        {
+            range_p->first_failure = use_p->index;
+            break;
+        }
+        translator_store(range_p->code_image, index, m);
+
+        /* Only J instructions may use an extern label (Then it is not a register, or "stop") */
+        if (use_p->type == J && symbol_p->type == EXTERNAL)
+        {
+            if (add_range_extern_use(range_p, symbol_p, IC_DEFAULT_VALUE + index) == WALK_NOT_ENOUGH_MEMORY)
+            {
+                range_p->out_of_memory = true;
+                range_p->first_failure = use_p->index;
+                break;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Encodes the decoded instructions of the IR, each range of instructions on it's own thread (The first one on
+ *        this thread), right into their slots of the code image; Then the extern uses of the ranges are merged, in
+ *        address order.
+ *
+ * @param instructions_p The decoded instructions of the IR.
+ * @param st             The symbols table.
+ * @param code_image_p   A pointer to the code image. It is reserved for all of the instructions.
+ * @param ranges_count   How many ranges (And threads)?
+ * @param arena_p        The compilation's arena.
+ * @param encoded_p      A pointer to where to put how many instructions (From the first one) were encoded.
+ * @return walk_status WALK_NOT_ENOUGH_MEMORY or WALK_OK.
+ */
+static walk_status encode_instructions(ir_instructions *instructions_p, symbols_table st, image *code_image_p, int ranges_count, arena *arena_p, unsigned long *encoded_p)
+{
+    encoding_range *ranges;
+    pthread_t *threads;
+    boolean *created;
+    int i;
+    unsigned long j, length = instructions_p->length;
+    walk_status status = WALK_OK;
+
+    ranges = arena_alloc(arena_p, sizeof(encoding_range) * ranges_count);
+    threads = arena_alloc(arena_p, sizeof(pthread_t) * ranges_count);
+    created = arena_alloc(arena_p, sizeof(boolean) * ranges_count);
+    if (!ranges || !threads || !created || image_reserve(code_image_p, length * INSTRUCTION_SIZE, arena_p) != WALK_OK)
+        return WALK_NOT_ENOUGH_MEMORY;
+
+    for (i = 0; i < ranges_count; i++)
+    {
+        ranges[i].instructions_p = instructions_p;
+        ranges[i].first = length / ranges_count * i;
+        ranges[i].end = (i == ranges_count - 1) ? length : length / ranges_count * (i + 1);
+        ranges[i].st = st;
+        ranges[i].code_image = code_image_p->content;
+        arena_init(&ranges[i].arena);
+        ranges[i].extern_uses = NULL;
+        ranges[i].extern_uses_count = ranges[i].extern_uses_capacity = 0;
+        ranges[i].out_of_memory = false;
+    }
+
+    /* The first range is encoded by this thread; If a thread cannot be created, it's range is encoded here too */
+    for (i = 1; i < ranges_count; i++)
+        created[i] = pthread_create(&threads[i], NULL, encode_range, &ranges[i]) == 0;
+    encode_range(&ranges[0]);
+    for (i = 1; i < ranges_count; i++)
+    {
+        if (created[i])
+            pthread_join(threads[i], NULL);
+        else
+            encode_range(&ranges[i]);
+    }
+
+    /* Everything up to the first failure is done. The ranges are in address order, and so are their uses */
+    *encoded_p = 0;
+    for (i = 0; i < ranges_count && status == WALK_OK; i++)
+    {
+        if (ranges[i].out_of_memory)
+            status = WALK_NOT_ENOUGH_MEMORY;
+        for (j = 0; j < ranges[i].extern_uses_count && status == WALK_OK; j++)
+            status = add_extern_use(ranges[i].extern_uses[j].symbol_p, ranges[i].extern_uses[j].ic, arena_p);
+
+        *encoded_p = ranges[i].first_failure;
+        if (ranges[i].first_failure != ranges[i].end)
+            break;
+    }
+
+    for (i = 0; i < ranges_count; i++)
+        arena_free(&ranges[i].arena);
+
+    return status;
+}
+
+walk_status second_walk(ir *program, symbols_table *symbols_table_p, unsigned long first_icf, unsigned long first_dcf, image *data_image_p, unsigned long *dcf_p, unsigned char **code_image, unsigned long *icf_p, arena *arena_p, int threads)
+{
+    unsigned long i, instructions_count = 0, encoded = 0;
+    int ranges_count;
     walk_status status;
     walk_status final_status = WALK_OK;
+    image code;
 
-    /* Initialize data image and code image */
-    *data_image = malloc(BUFFER_MIN_SIZE);
-    *code_image = malloc(BUFFER_MIN_SIZE);
-    if (!*data_image || !*code_image)
+    /* Initialize data image and code image - the first walk already counted them, so they never have to grow. The runs
+       of the data are not in it's content. */
+    if (image_init(data_image_p, first_dcf - DC_DEFAULT_VALUE - program->data_runs_size, arena_p) != WALK_OK ||
+        image_reserve_runs(data_image_p, program->data_runs_count, arena_p) != WALK_OK ||
+        image_init(&code, first_icf - IC_DEFAULT_VALUE, arena_p) != WALK_OK)
         return WALK_NOT_ENOUGH_MEMORY;
-    code_image_max_size = data_image_max_size = BUFFER_MIN_SIZE;
 
     *dcf_p = DC_DEFAULT_VALUE;
     *icf_p = IC_DEFAULT_VALUE;
 
-    /* Open the input file */
-    file = fopen(file_name, "r");
-    if (!file)
+    /* The addresses of the first walk are final, so the decoded instructions can be encoded in bulk - and in parallel,
+       if there are enough of them */
+    if (program->instructions.length > 0)
     {
-        printf("Error: Cannot open file \"%s\". Skipping.\n", file_name);
-        return WALK_IO_ERROR;
+        ranges_count = (int) (program->instructions.length / MIN_INSTRUCTIONS_PER_THREAD);
+        if (ranges_count > threads)
+            ranges_count = threads;
+        if (ranges_count < 1)
+            ranges_count = 1;
+        if (encode_instructions(&program->instructions, *symbols_table_p, &code, ranges_count, arena_p, &encoded) != WALK_OK)
+            return WALK_NOT_ENOUGH_MEMORY;
     }
 
-    /* Start! */
-    while ((status = get_next_command(file, &cmd, &line_number, false)) != WALK_EOF)
+    /* Start! The instructions that were already encoded are skipped; From the first one that was not, they are
+       encoded here - so the problems are logged in order, and the addresses after a problem are like before */
+    for (i = 0; i < ir_length(program); i++)
     {
-        if (status == WALK_NOT_ENOUGH_MEMORY)
-            return status;
+        ir_record *record = ir_get(program, i);
 
-        if (cmd.type == DIRECTIVE)
+        if (record->type == DIRECTIVE)
+            status = handle_directive(record, data_image_p, dcf_p, symbols_table_p, arena_p);
+        else if (instructions_count < encoded)
         {
-            if ((status = handle_directive(cmd, data_image, dcf_p, symbols_table_p, line_number)) != WALK_OK)
-            {
-                free_command(cmd);
-                if (status == WALK_PROBLEM_WITH_CODE)
-                    final_status = status;
-                else return status;
-            } else free_command(cmd);
+            instructions_count++;
+            *icf_p += INSTRUCTION_SIZE;
+            continue;
         }
         else /* Instruction */
-        {
-            if ((status = handle_instruction(cmd, *symbols_table_p, code_image, icf_p, line_number)) != WALK_OK)
-            {
-                free_command(cmd);
-                if (status == WALK_PROBLEM_WITH_CODE)
-                    final_status = status;
-                else return status;
-            } else free_command(cmd);
-        }
+            status = handle_instruction(record, *symbols_table_p, &code, icf_p, arena_p);
+
+        if (status == WALK_PROBLEM_WITH_CODE)
+            final_status = status;
+        else if (status != WALK_OK)
+            return status;
     }
 
-    fclose(file);
+    *code_image = code.content;
     return final_status;
 }
@@ -0,0 +1,377 @@
+#include "single_pass.h"
+#include "first_walk.h"
+#include "second_walk.h"
+#include "walk.h"
+#include "command.h"
+#include "symbol.h"
+#include "symbols_table.h"
+#include "translator.h"
+#include "instructions_table.h"
+#include "linked_list.h"
+#include "boolean.h"
+#include "arena.h"
+#include "ir.h"
+
+#include <string.h>
+
+typedef enum e_fixup_type
+{
+    FIXUP_LABEL, /* An instruction that uses a label */
+    FIXUP_ENTRY  /* An ".entry" directive; It can be checked only when all the labels are known */
+} fixup_type;
+
+/* Something that has to be done (Or checked) after a label is defined */
+typedef struct s_fixup
+{
+    fixup_type type;            /**< What kind of fixup is it? */
+    char *label;                /**< The name of the label. */
+    int line;                   /**< On what line is the instruction / directive? */
+
+    /* ONLY USED WHEN type=FIXUP_LABEL: */
+    unsigned long ic;           /**< The address of the instruction. */
+    instruction_type inst_type; /**< The type of the instruction - I (Conditional jump) or J. */
+    boolean resolved;           /**< Was the label already put in the instruction? */
+    struct s_fixup *next;       /**< The next instruction on the same label's fixup chain. */
+} fixup;
+
+/**
+ * @brief Creates a fixup, and appends it to the fixups list (Which is kept in the order of the lines).
+ *
+ * @param type      The type of the fixup.
+ * @param label     The name of the label. It is copied.
+ * @param line      On what line is the instruction / directive?
+ * @param fixups_p  The fixups list.
+ * @param arena_p   The arena to allocate the fixup from.
+ * @return fixup*   The new fixup, or NULL if there is not enough memory.
+ */
+static fixup *create_fixup(fixup_type type, char *label, int line, linked_list *fixups_p, arena *arena_p)
+{
+    fixup *fixup_p = arena_alloc(arena_p, sizeof(fixup));
+    if (!fixup_p)
+        return NULL;
+
+    fixup_p->label = arena_alloc(arena_p, strlen(label) + 1);
+    if (!fixup_p->label)
+        return NULL;
+    strcpy(fixup_p->label, label);
+
+    fixup_p->type = type;
+    fixup_p->line = line;
+    fixup_p->ic = 0;
+    fixup_p->resolved = false;
+    fixup_p->next = NULL;
+
+    if (linked_list_append(fixups_p, fixup_p) == LINKED_LIST_NOT_ENOUGH_MEMORY)
+        return NULL;
+
+    return fixup_p;
+}
+
+/**
+ * @brief Puts the given label's address in the instruction of the given fixup, and records the use if the label is
+ *        extern.
+ *
+ * @param fixup_p      The fixup. Must be of type FIXUP_LABEL.
+ * @param symbol_p     The label's symbol, or NULL if it does not exist.
+ * @param code_image_p A pointer to the code image.
+ * @param log          Should I log if the label cannot be put?
+ * @param arena_p      The arena to allocate the extern uses from.
+ * @return walk_status WALK_NOT_ENOUGH_MEMORY or WALK_PROBLEM_WITH_CODE or WALK_OK.
+ */
+static walk_status resolve_fixup(fixup *fixup_p, symbol *symbol_p, image *code_image_p, boolean log, arena *arena_p)
+{
+    unsigned long index = fixup_p->ic - IC_DEFAULT_VALUE; /* The index in the code image, IN BYTES */
+    machine_instruction m = translator_load(code_image_p->content, index);
+
+    if (translator_put_label(&m, fixup_p->inst_type, fixup_p->label, symbol_p, fixup_p->ic, fixup_p->line, log) != TRANSLATOR_OK)
+        return WALK_PROBLEM_WITH_CODE;
+    translator_store(code_image_p->content, index, m);
+    fixup_p->resolved = true;
+
+    if (symbol_p->type == EXTERNAL) /* Only a J instruction can get here with an extern label */
+        return add_extern_use(symbol_p, fixup_p->ic, arena_p);
+
+    return WALK_OK;
+}
+
+/**
+ * @brief Puts the given fixup on the fixup chain of it's label. The chains are held by placeholder symbols, in a
+ *        separate table, so the symbols table itself holds only defined labels.
+ *
+ * @param fixup_p   The fixup. Must be of type FIXUP_LABEL.
+ * @param pending   The table of the placeholder symbols.
+ * @param arena_p   The arena to allocate the placeholder from.
+ * @return walk_status WALK_NOT_ENOUGH_MEMORY or WALK_OK.
+ */
+static walk_status add_to_fixup_chain(fixup *fixup_p, symbols_table pending, arena *arena_p)
+{
+    symbol *placeholder;
+
+    if (strlen(fixup_p->label) > LABEL_MAX_LENGTH)
+        return WALK_OK; /* Such a label can never be defined; It will be reported at EOF */
+
+    placeholder = symbols_table_find(pending, fixup_p->label);
+    if (!placeholder)
+    {
+        placeholder = arena_alloc(arena_p, sizeof(symbol));
+        if (!placeholder)
+            return WALK_NOT_ENOUGH_MEMORY;
+        memset(placeholder, 0, sizeof(symbol));
+
+        strcpy(placeholder->name, fixup_p->label);
+        placeholder->fixups = NULL;
+
+        if (symbols_table_insert(pending, placeholder) == SYMBOLS_TABLE_NOT_ENOUGH_MEMORY)
+            return WALK_NOT_ENOUGH_MEMORY;
+    }
+
+    fixup_p->next = placeholder->fixups;
+    placeholder->fixups = fixup_p;
+
+    return WALK_OK;
+}
+
+/**
+ * @brief Resolves the fixup chain of the given label, which has just been defined.
+ *        Data labels are skipped - their addresses are known only at EOF.
+ *
+ * @param symbol_p     The new symbol.
+ * @param pending      The table of the placeholder symbols.
+ * @param code_image_p A pointer to the code image.
+ * @param arena_p      The arena to allocate the extern uses from.
+ * @return walk_status WALK_NOT_ENOUGH_MEMORY or WALK_OK.
+ */
+static walk_status resolve_fixup_chain(symbol *symbol_p, symbols_table pending, image *code_image_p, arena *arena_p)
+{
+    symbol *placeholder;
+    fixup *fixup_p, *reversed = NULL;
+
+    if (symbol_p->type == DATA)
+        return WALK_OK;
+
+    placeholder = symbols_table_find(pending, symbol_p->name);
+    if (!placeholder)
+        return WALK_OK; /* Nobody waits for it */
+
+    /* The chain holds the last instruction first; The extern uses must be recorded in ascending order */
+    while ((fixup_p = placeholder->fixups) != NULL)
+    {
+        placeholder->fixups = fixup_p->next;
+        fixup_p->next = reversed;
+        reversed = fixup_p;
+    }
+
+    for (fixup_p = reversed; fixup_p; fixup_p = fixup_p->next)
+    {
+        /* If it cannot be resolved, it stays unresolved, and it will be logged at EOF (In the order of the lines) */
+        if (resolve_fixup(fixup_p, symbol_p, code_image_p, false, arena_p) == WALK_NOT_ENOUGH_MEMORY)
+            return WALK_NOT_ENOUGH_MEMORY;
+    }
+
+    return WALK_OK;
+}
+
+/**
+ * @brief Encodes the given instruction into the code image. If it uses a label, a fixup is created for it; If the
+ *        label is already defined (And it is not a data label), it is put right away.
+ *
+ * @param record       The instruction. MUST BE VALIDATED.
+ * @param st           The symbols table.
+ * @param pending      The table of the placeholder symbols.
+ * @param code_image_p A pointer to the code image.
+ * @param fixups_p     The fixups list.
+ * @param arena_p      The compilation's arena.
+ * @return walk_status WALK_NOT_ENOUGH_MEMORY or WALK_OK.
+ */
+static walk_status handle_instruction(ir_record *record, symbols_table st, symbols_table pending, image *code_image_p, linked_list *fixups_p, arena *arena_p)
+{
+    machine_instruction m;
+    instruction_type type;
+    char *label;
+    symbol *symbol_p;
+    fixup *fixup_p;
+    unsigned long index = record->pc - IC_DEFAULT_VALUE; /* The index in the code image, IN BYTES */
+
+    label = translator_translate_partial(record, &m, &type);
+
+    /* Is the image big enough? */
+    if (image_reserve(code_image_p, index + INSTRUCTION_SIZE, arena_p) != WALK_OK)
+        return WALK_NOT_ENOUGH_MEMORY;
+    translator_store(code_image_p->content, index, m);
+
+    if (!label)
+        return WALK_OK; /* It is complete */
+
+    if (!(fixup_p = create_fixup(FIXUP_LABEL, label, record->line, fixups_p, arena_p)))
+        return WALK_NOT_ENOUGH_MEMORY;
+    fixup_p->ic = record->pc;
+    fixup_p->inst_type = type;
+
+    symbol_p = symbols_table_find(st, label);
+    if (!symbol_p)
+        return add_to_fixup_chain(fixup_p, pending, arena_p);
+
+    if (symbol_p->type == DATA)
+        return WALK_OK; /* It's address is known only at EOF */
+
+    if (resolve_fixup(fixup_p, symbol_p, code_image_p, false, arena_p) == WALK_NOT_ENOUGH_MEMORY)
+        return WALK_NOT_ENOUGH_MEMORY;
+
+    return WALK_OK;
+}
+
+/**
+ * @brief Handles the given directive. ".entry" is checked only at EOF, because the label may be defined after it.
+ *
+ * @param record       The directive. MUST BE VALIDATED.
+ * @param data_image_p A pointer to the data image.
+ * @param fixups_p     The fixups list.
+ * @param arena_p      The compilation's arena.
+ * @return walk_status WALK_NOT_ENOUGH_MEMORY or WALK_OK.
+ */
+static walk_status handle_directive(ir_record *record, image *data_image_p, linked_list *fixups_p, arena *arena_p)
+{
+    unsigned long dc = record->dc; /* The pass advances it's own DC, by next_counter() */
+
+    switch (record->dir->id)
+    {
+    case DIRECTIVE_ENTRY:
+        return create_fixup(FIXUP_ENTRY, record->operands[0], record->line, fixups_p, arena_p) ? WALK_OK : WALK_NOT_ENOUGH_MEMORY;
+    case DIRECTIVE_DB:
+    case DIRECTIVE_DH:
+    case DIRECTIVE_DW:
+        return handle_define_directive(record, data_image_p, &dc, arena_p);
+    case DIRECTIVE_ASCIZ:
+        return handle_asciz_directive(record, data_image_p, &dc, arena_p);
+    case DIRECTIVE_SPACE:
+    case DIRECTIVE_FILL:
+        return handle_run_directive(record, data_image_p, &dc, arena_p);
+    default: /* ".extern" - the symbol was already put */
+        return WALK_OK;
+    }
+}
+
+/**
+ * @brief Does everything that had to wait for EOF, in the order of the lines - like the second walk would have:
+ *        Marks the entries, and resolves the fixups that are not resolved yet. Logs every problem.
+ *
+ * @param st           The symbols table. Complete, and with the data symbols relocated.
+ * @param fixups_p     The fixups list.
+ * @param code_image_p A pointer to the code image.
+ * @param arena_p      The arena to allocate the extern uses from.
+ * @return walk_status WALK_NOT_ENOUGH_MEMORY or WALK_PROBLEM_WITH_CODE or WALK_OK.
+ */
+static walk_status resolve_fixups(symbols_table st, linked_list *fixups_p, image *code_image_p, arena *arena_p)
+{
+    linked_list_iterator it;
+    void *data;
+    walk_status status, final_status = WALK_OK;
+    unsigned long failures = 0; /* How many instructions could not be translated? */
+
+    linked_list_iterator_init(&it, fixups_p);
+    while (linked_list_iterator_next(&it, &data))
+    {
+        fixup *fixup_p = data;
+
+        if (fixup_p->type == FIXUP_ENTRY)
+        {
+            if (handle_entry_directive(fixup_p->label, st, fixup_p->line) != WALK_OK)
+                final_status = WALK_PROBLEM_WITH_CODE;
+        }
+        else if (failures > 0)
+        {
+            /* The second walk does not advance the IC over an instruction that it cannot translate, so the next
+               instructions are checked with a smaller IC. The images are not written anyway - only check it. */
+            machine_instruction m = 0;
+            if (translator_put_label(&m, fixup_p->inst_type, fixup_p->label, symbols_table_find(st, fixup_p->label),
+                                     fixup_p->ic - failures * INSTRUCTION_SIZE, fixup_p->line, true) != TRANSLATOR_OK)
+                failures++;
+        }
+        else if (!fixup_p->resolved)
+        {
+            status = resolve_fixup(fixup_p, symbols_table_find(st, fixup_p->label), code_image_p, true, arena_p);
+            if (status == WALK_NOT_ENOUGH_MEMORY)
+                return status;
+            if (status == WALK_PROBLEM_WITH_CODE)
+            {
+                failures++;
+                final_status = status;
+            }
+        }
+    }
+
+    return final_status;
+}
+
+walk_status single_pass(source_file *source, symbols_table *symbols_table_p, image *data_image_p, unsigned long *dcf_p, unsigned char **code_image, unsigned long *icf_p, arena *arena_p, pipeline *pipeline_p)
+{
+    command cmd;
+    command_buffer buffer;
+    ir_record record;
+    int line_number = 0;
+    unsigned long pc = IC_DEFAULT_VALUE, dc = DC_DEFAULT_VALUE;
+    walk_status status, final_status = WALK_OK;
+    symbols_table pending;
+    linked_list fixups;
+    image code;
+    symbol *new_symbol;
+
+    pending = symbols_table_create(arena_p);
+    if (!pending)
+        return WALK_NOT_ENOUGH_MEMORY;
+    linked_list_init(&fixups, arena_p);
+
+    /* The sizes are known only at EOF - the images grow as the source is read */
+    if (image_init(data_image_p, 0, arena_p) != WALK_OK || image_init(&code, 0, arena_p) != WALK_OK)
+        return WALK_NOT_ENOUGH_MEMORY;
+
+    if (!pipeline_p)
+        source_file_rewind(source);
+    while ((status = pipeline_p ? pipeline_next_command(pipeline_p, &cmd, &line_number) : get_next_command(source, &buffer, &cmd, &line_number, true)) != WALK_EOF)
+    {
+        if (status == WALK_NOT_ENOUGH_MEMORY)
+            return status;
+        if (status == WALK_PROBLEM_WITH_CODE)
+        {
+            final_status = status;
+            continue;
+        }
+
+        status = put_symbol(cmd, symbols_table_p, pc, dc, line_number, arena_p, &new_symbol);
+        if (status == WALK_PROBLEM_WITH_CODE)
+            final_status = status;
+        else if (status == WALK_OK && new_symbol && final_status == WALK_OK)
+            status = resolve_fixup_chain(new_symbol, pending, &code, arena_p);
+        if (check_address_range(pc, dc, cmd, line_number) == WALK_PROBLEM_WITH_CODE)
+            final_status = WALK_PROBLEM_WITH_CODE;
+
+        /* Once there is a problem, the images will not be written - only look for more problems */
+        if (status == WALK_OK && final_status == WALK_OK)
+        {
+            ir_record_view(&record, &cmd, line_number, pc, dc); /* It is handled right away, so there is no need to copy it */
+            if (record.type == DIRECTIVE)
+                status = handle_directive(&record, data_image_p, &fixups, arena_p);
+            else
+                status = handle_instruction(&record, *symbols_table_p, pending, &code, &fixups, arena_p);
+        }
+
+        if (status == WALK_NOT_ENOUGH_MEMORY)
+            return status;
+
+        next_counter(&pc, &dc, cmd);
+    }
+
+    /* Like the second walk - it does not start if the source has problems */
+    if (final_status != WALK_OK)
+        return final_status;
+
+    /* Now the data symbols' addresses are known */
+    relocate_data_symbols(*symbols_table_p, pc);
+
+    final_status = resolve_fixups(*symbols_table_p, &fixups, &code, arena_p);
+
+    *code_image = code.content;
+    *dcf_p = dc;
+    *icf_p = pc;
+    return final_status;
+}
@@ -0,0 +1,240 @@
+#define _POSIX_C_SOURCE 200112L /* For mmap() and friends */
+
+#include "source_file.h"
+#include "boolean.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#define READ_CHUNK_SIZE 65536
+
+#define BLOCK_SIZE (sizeof(unsigned long) * CHAR_BIT) /* A bit of the newlines mask for every char */
+
+/**
+ * @brief Finds the newlines of a part of a block, one char at a time.
+ *
+ * @param block  The block.
+ * @param length How many chars to scan. At most BLOCK_SIZE.
+ * @return unsigned long A bit for every '\n'.
+ */
+static unsigned long find_newlines_slow(char *block, size_t length)
+{
+    unsigned long newlines = 0;
+    size_t i;
+
+    for (i = 0; i < length; i++)
+        if (block[i] == '\n')
+            newlines |= 1UL << i;
+
+    return newlines;
+}
+
+/**
+ * @brief Finds the newlines of a whole block.
+ *
+ * @param block The block. It must have BLOCK_SIZE chars.
+ * @return unsigned long A bit for every '\n'.
+ */
+static unsigned long find_newlines(char *block)
+{
+#if defined(__AVX2__)
+    __m256i newline = _mm256_set1_epi8('\n');
+    unsigned long newlines = 0;
+    size_t i;
+
+    for (i = 0; i < BLOCK_SIZE; i += sizeof(__m256i))
+    {
+        __m256i chars = _mm256_loadu_si256((__m256i *) (block + i));
+        newlines |= (unsigned long) (unsigned int) _mm256_movemask_epi8(_mm256_cmpeq_epi8(chars, newline)) << i;
+    }
+
+    return newlines;
+#elif defined(__SSE2__)
+    __m128i newline = _mm_set1_epi8('\n');
+    unsigned long newlines = 0;
+    size_t i;
+
+    for (i = 0; i < BLOCK_SIZE; i += sizeof(__m128i))
+    {
+        __m128i chars = _mm_loadu_si128((__m128i *) (block + i));
+        newlines |= (unsigned long) _mm_movemask_epi8(_mm_cmpeq_epi8(chars, newline)) << i;
+    }
+
+    return newlines;
+#else
+    return find_newlines_slow(block, BLOCK_SIZE);
+#endif
+}
+
+/**
+ * @brief Gives the index of the lowest bit of the given mask.
+ *
+ * @param mask The mask. Must not be 0.
+ * @return size_t The index.
+ */
+static size_t lowest_bit(unsigned long mask)
+{
+#if defined(__GNUC__)
+    return (size_t) __builtin_ctzl(mask);
+#else
+    size_t i = 0;
+
+    while (!(mask & 1))
+    {
+        mask >>= 1;
+        i++;
+    }
+
+    return i;
+#endif
+}
+
+/**
+ * @brief Reads everything from the given file descriptor into a buffer. Used when the file cannot be mapped.
+ *        A read error is treated like the end of the file.
+ *
+ * @param fd     The file descriptor.
+ * @param source The source file to fill.
+ * @return source_file_status SOURCE_FILE_NOT_ENOUGH_MEMORY or SOURCE_FILE_OK.
+ */
+static source_file_status read_content(int fd, source_file *source)
+{
+    size_t capacity = 0;
+    ssize_t count;
+
+    source->content = NULL;
+    source->size = 0;
+    source->mapped = false;
+
+    while (1)
+    {
+        if (source->size + READ_CHUNK_SIZE > capacity)
+        {
+            char *new_content = realloc(source->content, capacity * 2 + READ_CHUNK_SIZE);
+            if (!new_content)
+            {
+                free(source->content);
+                return SOURCE_FILE_NOT_ENOUGH_MEMORY;
+            }
+            source->content = new_content;
+            capacity = capacity * 2 + READ_CHUNK_SIZE;
+        }
+
+        count = read(fd, source->content + source->size, READ_CHUNK_SIZE);
+        if (count <= 0)
+            break;
+        source->size += (size_t) count;
+    }
+
+    return SOURCE_FILE_OK;
+}
+
+source_file_status source_file_open(char *file_name, source_file *source)
+{
+    int fd;
+    struct stat file_stat;
+    source_file_status status;
+
+    fd = open(file_name, O_RDONLY);
+    if (fd < 0)
+        return SOURCE_FILE_IO_ERROR;
+
+    source_file_rewind(source);
+
+    if (fstat(fd, &file_stat) == 0 && S_ISREG(file_stat.st_mode) && file_stat.st_size > 0)
+    {
+        void *content = mmap(NULL, (size_t) file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (content != MAP_FAILED)
+        {
+            posix_madvise(content, (size_t) file_stat.st_size, POSIX_MADV_SEQUENTIAL);
+            source->content = content;
+            source->size = (size_t) file_stat.st_size;
+            source->mapped = true;
+            close(fd);
+            return SOURCE_FILE_OK;
+        }
+    }
+
+    /* It cannot be mapped (A pipe, an empty file...) - read it */
+    status = read_content(fd, source);
+
+    close(fd);
+    return status;
+}
+
+void source_file_from_buffer(char *content, size_t size, source_file *source)
+{
+    source->content = content;
+    source->size = size;
+    source->mapped = false;
+    source_file_rewind(source);
+}
+
+source_file_status source_file_next_line(source_file *source, line_view *line)
+{
+    size_t newline;
+
+    if (source->position >= source->size)
+        return SOURCE_FILE_EOF;
+
+    /* Scan blocks until there is a newline that was not given yet */
+    while (!source->newlines && source->scanned < source->size)
+    {
+        size_t length = source->size - source->scanned;
+
+        source->block_start = source->scanned;
+        if (length >= BLOCK_SIZE)
+        {
+            source->newlines = find_newlines(source->content + source->block_start);
+            source->scanned += BLOCK_SIZE;
+        }
+        else /* Do not read after the end of the content */
+        {
+            source->newlines = find_newlines_slow(source->content + source->block_start, length);
+            source->scanned = source->size;
+        }
+    }
+
+    line->start = source->content + source->position;
+    if (source->newlines)
+    {
+        newline = source->block_start + lowest_bit(source->newlines);
+        source->newlines &= source->newlines - 1; /* This one is given */
+        line->length = newline - source->position;
+        source->position = newline + 1; /* +1 to skip the '\n' */
+    }
+    else /* The last line has no '\n' */
+    {
+        line->length = source->size - source->position;
+        source->position = source->size;
+    }
+
+    return SOURCE_FILE_OK;
+}
+
+void source_file_rewind(source_file *source)
+{
+    source->position = 0;
+    source->block_start = source->scanned = 0;
+    source->newlines = 0;
+}
+
+void source_file_close(source_file *source)
+{
+    if (source->mapped)
+        munmap(source->content, source->size);
+    else
+        free(source->content);
+
+    source->content = NULL;
+    source->size = source->position = 0;
+}
@@ -1,27 +1,44 @@
 #include "str_helper.h"
 #include <ctype.h>
+#include <limits.h>
 
-void skip_whitespaces(char **ptr)
+boolean parse_number(char* str, long *value_p, size_t *length_p)
 {
-    while (isspace(**ptr) && **ptr)
-        (*ptr)++;
-}
-
-boolean is_number(char* str)
-{
-    /* A number cannot be empty */
-    if (!*str)
-        return false;
+    char *start = str;
+    boolean negative = false, is_number = true, overflow = false;
+    unsigned long magnitude = 0, limit;
 
     /* There can be a minus or plus sign at the beginning */
     if (*str == '-' || *str == '+')
-        str++;
+        negative = *str++ == '-';
+    limit = negative ? (unsigned long) LONG_MAX + 1 : (unsigned long) LONG_MAX;
 
-    while (*str)
+    /* A number cannot be empty */
+    if (!*start)
+        is_number = false;
+
+    for (; *str; str++)
     {
-        if (!isdigit(*str++))
-            return false;
+        unsigned long digit = (unsigned long) (*str - '0');
+
+        if (!isdigit(*str))
+            is_number = false;
+        else if (!overflow)
+        {
+            if (magnitude > (limit - digit) / 10)
+                overflow = true;
+            else
+                magnitude = magnitude * 10 + digit;
+        }
     }
 
-    return true;
-}
\ No newline at end of file
+    *length_p = (size_t) (str - start);
+    if (overflow)
+        *value_p = negative ? LONG_MIN : LONG_MAX;
+    else if (negative)
+        *value_p = magnitude == (unsigned long) LONG_MAX + 1 ? LONG_MIN : -(long) magnitude;
+    else
+        *value_p = (long) magnitude;
+
+    return is_number;
+}
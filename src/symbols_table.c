@@ -0,0 +1,131 @@
+#include "symbols_table.h"
+#include "symbol.h"
+#include "arena.h"
+
+#include <string.h>
+
+#define INITIAL_SLOTS_CAPACITY   64 /* Must be a power of 2 */
+#define INITIAL_SYMBOLS_CAPACITY 32
+
+#define FNV_OFFSET_BASIS 2166136261UL
+#define FNV_PRIME        16777619UL
+
+/**
+ * @brief Hashes the given symbol name (FNV-1a).
+ *
+ * @param name           The name to hash.
+ * @return unsigned long The hash.
+ */
+static unsigned long hash_name(char *name)
+{
+    unsigned long hash = FNV_OFFSET_BASIS;
+
+    while (*name)
+    {
+        hash ^= (unsigned char) *name++;
+        hash *= FNV_PRIME;
+    }
+
+    return hash;
+}
+
+/**
+ * @brief Returns the slot in which the given name is, or the empty slot where it should be inserted.
+ *
+ * @param slots     The slots array.
+ * @param capacity  The length of the slots array. Must be a power of 2, and the array must contain an empty slot.
+ * @param name      The name to look for.
+ * @return symbol** A pointer to the slot.
+ */
+static symbol **find_slot(symbol **slots, unsigned long capacity, char *name)
+{
+    unsigned long mask = capacity - 1;
+    unsigned long i = hash_name(name) & mask;
+
+    while (slots[i] && strcmp(slots[i]->name, name) != 0)
+        i = (i + 1) & mask;
+
+    return &slots[i];
+}
+
+/**
+ * @brief Doubles the number of slots of the given table, and rehashes all of the symbols into them.
+ *        The old slots stay in the arena until it is reset; Since the table doubles, they never take more than the new slots.
+ *
+ * @param st The symbols table.
+ * @return symbols_table_status SYMBOLS_TABLE_NOT_ENOUGH_MEMORY or SYMBOLS_TABLE_OK.
+ */
+static symbols_table_status grow_slots(symbols_table st)
+{
+    unsigned long i, new_capacity = st->slots_capacity * 2;
+    symbol **new_slots = arena_alloc(st->arena_p, new_capacity * sizeof(symbol *));
+    if (!new_slots)
+        return SYMBOLS_TABLE_NOT_ENOUGH_MEMORY;
+    memset(new_slots, 0, new_capacity * sizeof(symbol *));
+
+    /* The symbols array holds every symbol exactly once, so it is easier to rehash from it */
+    for (i = 0; i < st->length; i++)
+        *find_slot(new_slots, new_capacity, st->symbols[i]->name) = st->symbols[i];
+
+    st->slots = new_slots;
+    st->slots_capacity = new_capacity;
+
+    return SYMBOLS_TABLE_OK;
+}
+
+symbols_table symbols_table_create(arena *arena_p)
+{
+    symbols_table st = arena_alloc(arena_p, sizeof(symbols_table_data));
+    if (!st)
+        return NULL;
+
+    st->arena_p = arena_p;
+    st->slots = arena_alloc(arena_p, INITIAL_SLOTS_CAPACITY * sizeof(symbol *));
+    st->symbols = arena_alloc(arena_p, INITIAL_SYMBOLS_CAPACITY * sizeof(symbol *));
+    if (!st->slots || !st->symbols)
+        return NULL;
+    memset(st->slots, 0, INITIAL_SLOTS_CAPACITY * sizeof(symbol *));
+
+    st->slots_capacity = INITIAL_SLOTS_CAPACITY;
+    st->symbols_capacity = INITIAL_SYMBOLS_CAPACITY;
+    st->length = 0;
+
+    return st;
+}
+
+symbols_table_status symbols_table_insert(symbols_table st, symbol *symbol_p)
+{
+    /* Keep the load factor at most 1/2, so the probe sequences stay short */
+    if ((st->length + 1) * 2 > st->slots_capacity)
+        if (grow_slots(st) != SYMBOLS_TABLE_OK)
+            return SYMBOLS_TABLE_NOT_ENOUGH_MEMORY;
+
+    if (st->length == st->symbols_capacity)
+    {
+        symbol **new_symbols = arena_realloc(st->arena_p, st->symbols, st->symbols_capacity * sizeof(symbol *), st->symbols_capacity * 2 * sizeof(symbol *));
+        if (!new_symbols)
+            return SYMBOLS_TABLE_NOT_ENOUGH_MEMORY;
+        st->symbols = new_symbols;
+        st->symbols_capacity *= 2;
+    }
+
+    *find_slot(st->slots, st->slots_capacity, symbol_p->name) = symbol_p;
+    st->symbols[st->length++] = symbol_p;
+
+    return SYMBOLS_TABLE_OK;
+}
+
+symbol *symbols_table_find(symbols_table st, char *name)
+{
+    return *find_slot(st->slots, st->slots_capacity, name);
+}
+
+unsigned long symbols_table_length(symbols_table st)
+{
+    return st->length;
+}
+
+symbol *symbols_table_get(symbols_table st, unsigned long index)
+{
+    return st->symbols[index];
+}
@@ -1,12 +1,12 @@
 #include "translator.h"
 #include "instructions_table.h"
-#include "bitmap.h"
 #include "walk.h"
 #include "symbol.h"
+#include "symbols_table.h"
 #include "utils.h"
 #include "logger.h"
+#include "ir.h"
 
-#include <stdlib.h>
 #include <string.h>
 
 #define R_COPY_INSTRUCTIONS_NUMBER_OF_OPERANDS 2
@@ -35,185 +35,241 @@
 #define ADDRESS_START 0
 #define ADDRESS_END 24
 
+#define BITS_PER_BYTE 8
+
 #define I_INSTRUCTION_IMMED_SIZE_BITS (IMMED_END - IMMED_START + 1)
 
 #define TRANSLATOR "Translator"
 #define PROBLEM_WITH_CODE "ProblemWithCode"
 #define OVERFLOW "Overflow"
 
-/**
- * @brief Converts a register string (line "$3") to it's int representation. (Like 3).
- * 
- * @param register_str The register string. MUST be validated.
- * @return int         The register number.
- */
-static int register_string_to_int(char *register_str)
+/* The mask of the bits of a field, before it is shifted to it's place */
+#define FIELD_MASK(start, end) ((machine_instruction) ((1UL << ((end) - (start) + 1)) - 1))
+
+/* The given value, cut to the width of the field and shifted to it's place (A negative value is in 2's complement) */
+#define FIELD(value, start, end) (((machine_instruction) (value) & FIELD_MASK(start, end)) << (start))
+
+/* The base word of every instruction - with it's opcode and funct already in place - by it's id */
+#define INSTRUCTION(id, name, type, funct, opcode, number_of_operands, operands_types) \
+	FIELD(opcode, OPCODE_START, OPCODE_END) | FIELD(funct, FUNCT_START, FUNCT_END),
+
+static const machine_instruction base_words[INSTRUCTIONS_COUNT] = {
+#include "instructions_list.h"
+};
+
+#undef INSTRUCTION
+
+/* The machine instruction of the given fields (See instruction_fields) */
+#define ENCODE(id, rs, rt, rd, immed) \
+	(base_words[id] | FIELD(rs, RS_START, RS_END) | FIELD(rt, RT_START, RT_END) | FIELD(rd, RD_START, RD_END) | \
+	 (machine_instruction) (immed))
+
+/* The fields of a decoded instruction, besides it's opcode and funct. A field that the instruction does not have is 0 */
+typedef struct s_instruction_fields
 {
-	return atoi(++register_str); /* Increment to skip the '$' */
-}
+	unsigned char rs, rt, rd;
+	unsigned long immed; /* The immed of an I instruction, or the reg bit and the address of a J instruction - in place */
+} instruction_fields;
 
 /**
- * @brief Translates an R instruction into it's machine language representation.
+ * @brief Decodes an R instruction into it's fields.
 
- * @param m                  A pointer to a machine_instruction; Will be filled with the instruction.
- * @param cmd  The command to translate. MUST BE VALIDATED!
- * @param inst The instruction struct that represents the insturction.
+ * @param fields_p A pointer to the fields; Will be filled.
+ * @param record   The command to decode. MUST BE VALIDATED!
+ * @param inst     The instruction struct that represents the insturction.
  */
-void translate_R_instruction(machine_instruction *m, command cmd, instruction inst)
+static void decode_R_instruction(instruction_fields *fields_p, ir_record *record, instruction *inst)
 {
-	int rs, rt, rd;
-
-	bitmap_put_data(m, &inst.opcode, OPCODE_START, OPCODE_END); /* Put opcode */
-	bitmap_put_data(m, &inst.funct, FUNCT_START, FUNCT_END);	/* Put funct */
+	fields_p->rs = (unsigned char) record->values[0];
 
-	if (inst.number_of_operands == R_COPY_INSTRUCTIONS_NUMBER_OF_OPERANDS)
+	if (inst->number_of_operands == R_COPY_INSTRUCTIONS_NUMBER_OF_OPERANDS)
 	{
 		/* This is a copy instruction. */
-		rs = register_string_to_int(cmd.operands[0]);
-		rd = register_string_to_int(cmd.operands[1]);
-		rt = 0;
+		fields_p->rd = (unsigned char) record->values[1];
 	}
 	else /* This is an arthimetic-login instruction. */
 	{
-		rs = register_string_to_int(cmd.operands[0]);
-		rt = register_string_to_int(cmd.operands[1]);
-		rd = register_string_to_int(cmd.operands[2]);
+		fields_p->rt = (unsigned char) record->values[1];
+		fields_p->rd = (unsigned char) record->values[2];
 	}
-
-	bitmap_put_data(m, &rs, RS_START, RS_END); /* Put rs */
-	bitmap_put_data(m, &rt, RT_START, RT_END); /* Put rt */
-	bitmap_put_data(m, &rd, RD_START, RD_END); /* Put rd */
 }
 
+
 /**
- * @brief Translates an I instruction into it's machine language representation.
+ * @brief Decodes an I instruction into it's fields, except of the label's offset (If it is a conditional jump).
  *
- * @param m                  A pointer to a machine_instruction; Will be filled with the instruction.
- * @param cmd                The command to translate. MUST BE VALIDATED!
- * @param inst               The instruction struct that represents the insturction.
- * @param st                 The symbols table.
- * @param ic                 The current instruction counter.
- * @param line                 On what line this instruction is?
- * @return translator_status TRANSLATOR_OK or TRANSLATOR_LABEL_DOES_NOT_EXIST or TRANSLATOR_OVERFLOW.
+ * @param fields_p A pointer to the fields; Will be filled.
+ * @param record   The command to decode. MUST BE VALIDATED!
+ * @param inst     The instruction struct that represents the insturction.
+ * @return char*   The label that the instruction jumps to, or NULL if it does not use a label.
  */
-static translator_status translate_I_instruction(machine_instruction *m, command cmd, instruction inst, symbols_table st, unsigned long ic, int line)
+static char *decode_I_instruction(instruction_fields *fields_p, ir_record *record, instruction *inst)
 {
-	int rs, rt;
-	int immed;
-	symbol *symbol_p;
-	int offset;
-
-	/* Put the opcode */
-	bitmap_put_data(m, &inst.opcode, OPCODE_START, OPCODE_END);
+	fields_p->rs = (unsigned char) record->values[0];
 
 	/* There are two operands arrangement. A way to distinguish between them is to know that "conditional jump" gets
 	   a label as the third operand.
 	*/
-	if (inst.operands_types[2] == LABEL)
+	if (inst->operands_types[2] == LABEL)
 	{
-		/* Conditional jump */
-		rs = register_string_to_int(cmd.operands[0]);
-		rt = register_string_to_int(cmd.operands[1]);
-		symbol_p = find_symbol(cmd.operands[2], st);
-		if (!symbol_p)
-		{
-			logger_log(TRANSLATOR, PROBLEM_WITH_CODE, line, "Label \"%s\" does not exist", cmd.operands[2]);
-			return TRANSLATOR_LABEL_DOES_NOT_EXIST;
-		}
-		if (symbol_p->type == EXTERNAL)
-		{
-			logger_log(TRANSLATOR, PROBLEM_WITH_CODE, line, "Conditional jumps cannot get external labels as an argument");
-			return TRANSLATOR_LABEL_DOES_NOT_EXIST;
-		}
-
-		offset = (int) (symbol_p->value - ic);
-		if (!is_in_range_2_complement(offset, I_INSTRUCTION_IMMED_SIZE_BITS))
-		{
-			logger_log(TRANSLATOR, OVERFLOW, line, "Label \"%s\" is too far!", cmd.operands[2]);
-			return TRANSLATOR_OVERFLOW;
-		}
-		immed = offset;
+		/* Conditional jump - the immed is the label's offset, which is put by translator_put_label() */
+		fields_p->rt = (unsigned char) record->values[1];
+		return record->operands[2];
 	}
-	else
+
+	/* Arthimetic logic or memory instructions: rs, immed, rt */
+	fields_p->rt = (unsigned char) record->values[2];
+	fields_p->immed = FIELD(record->values[1], IMMED_START, IMMED_END);
+	return NULL;
+}
+
+/**
+ * @brief Decodes an J instruction into it's fields, except of the label's address (If it uses a label).
+ *
+ * @param fields_p A pointer to the fields; Will be filled.
+ * @param record   The command to decode. MUST BE VALIDATED!
+ * @param inst     The instruction struct that represents the insturction.
+ * @return char*   The label that the instruction jumps to, or NULL if it does not use a label.
+ */
+static char *decode_J_instruction(instruction_fields *fields_p, ir_record *record, instruction *inst)
+{
+	if (inst->id == INSTRUCTION_STOP) /* "stop" is the only J instruction that does not accept a label */
+		return NULL;
+
+	if (*record->operands[0] == '$') /* This is a jmp instruction with a register */
 	{
-		/* Arthimetic logic or memory instructions */
-		rs = register_string_to_int(cmd.operands[0]);
-		rt = register_string_to_int(cmd.operands[2]);
-		immed = atoi(cmd.operands[1]);
+		fields_p->immed = FIELD(1, REG_START, REG_END) | FIELD(record->values[0], ADDRESS_START, ADDRESS_END);
+		return NULL;
 	}
 
-	bitmap_put_data(m, &rs, RS_START, RS_END);			/* Put rs */
-	bitmap_put_data(m, &rt, RT_START, RT_END);			/* Put rt */
-	bitmap_put_data(m, &immed, IMMED_START, IMMED_END); /* Put immed */
-
-	return TRANSLATOR_OK;
+	return record->operands[0]; /* The address is put by translator_put_label() */
 }
 
 /**
- * @brief Translates an J instruction into it's machine language representation.
+ * @brief Decodes the given instruction into it's fields, except of the label's field (If it uses a label).
  *
- * @param m                  A pointer to a machine_instruction; Will be filled with the instruction.
- * @param cmd                The command to translate. MUST BE VALIDATED!
- * @param inst               The instruction struct that represents the insturction.
- * @param st                 The symbols table.
- * @param line               On what line this instruction is?
- * @return translator_status TRANSLATOR_OK or TRANSLATOR_LABEL_DOES_NOT_EXIST or TRANSLATOR_OVERFLOW.
+ * @param fields_p A pointer to the fields; Will be filled.
+ * @param record   The command to decode. MUST BE VALIDATED!
+ * @return char*   The label that the instruction uses, or NULL if it does not use a label.
  */
-static translator_status translate_J_instruction(machine_instruction *m, command cmd, instruction inst, symbols_table st, int line)
+static char *decode_instruction(instruction_fields *fields_p, ir_record *record)
 {
-	int reg = 0;
+	instruction *inst = record->inst;
+
+	memset(fields_p, 0, sizeof(instruction_fields));
+	if (inst->type == R)
+	{
+		decode_R_instruction(fields_p, record, inst);
+		return NULL;
+	}
+	else if (inst->type == I)
+		return decode_I_instruction(fields_p, record, inst);
+	else /* J */
+		return decode_J_instruction(fields_p, record, inst);
+}
+
+char *translator_translate_partial(ir_record *record, machine_instruction *m, instruction_type *type_p)
+{
+	instruction_fields fields;
+	char *label = decode_instruction(&fields, record);
+
+	*type_p = record->inst->type;
+	*m = ENCODE(record->inst->id, fields.rs, fields.rt, fields.rd, fields.immed);
+	return label;
+}
+
+char *translator_decode(ir_record *record, ir_instructions *instructions_p, unsigned long index)
+{
+	instruction_fields fields;
+	char *label = decode_instruction(&fields, record);
+
+	instructions_p->ids[index] = (unsigned char) record->inst->id;
+	instructions_p->rs[index] = fields.rs;
+	instructions_p->rt[index] = fields.rt;
+	instructions_p->rd[index] = fields.rd;
+	instructions_p->immeds[index] = fields.immed;
+	return label;
+}
+
+void translator_encode(ir_instructions *instructions_p, unsigned long first, unsigned long end, unsigned char *code_image)
+{
+	unsigned char *ids = instructions_p->ids, *rs = instructions_p->rs, *rt = instructions_p->rt, *rd = instructions_p->rd;
+	unsigned long *immeds = instructions_p->immeds;
+	unsigned long i;
+
+	/* The fields are already in place - every instruction is a few shifts and ORs, whatever it's type is */
+	for (i = first; i < end; i++)
+		translator_store(code_image, i * INSTRUCTION_SIZE, ENCODE(ids[i], rs[i], rt[i], rd[i], immeds[i]));
+}
+
+translator_status translator_put_label(machine_instruction *m, instruction_type type, char *label, symbol *symbol_p, unsigned long ic, int line, boolean log)
+{
+	int offset;
 	unsigned long address;
-	symbol *symbol_p;
-	char* label;
 
-	/* Put the opcode */
-	bitmap_put_data(m, &inst.opcode, OPCODE_START, OPCODE_END);
+	if (!symbol_p)
+	{
+		if (log)
+			logger_log(TRANSLATOR, PROBLEM_WITH_CODE, line, "Label \"%s\" does not exist", label);
+		return TRANSLATOR_LABEL_DOES_NOT_EXIST;
+	}
 
-	if (strcmp(cmd.command_name, "stop") == 0) /* The only J instruction that does not accept a label */
-		address = 0;
-	else
+	if (type == I) /* Conditional jump - put the offset */
 	{
-		if (*cmd.operands[0] == '$') /* This is a jmp instruction with a register */
+		if (symbol_p->type == EXTERNAL)
+		{
+			if (log)
+				logger_log(TRANSLATOR, PROBLEM_WITH_CODE, line, "Conditional jumps cannot get external labels as an argument");
+			return TRANSLATOR_LABEL_DOES_NOT_EXIST;
+		}
+
+		offset = (int) (symbol_p->value - ic);
+		if (!is_in_range_2_complement(offset, I_INSTRUCTION_IMMED_SIZE_BITS))
 		{
-			reg = 1;
-			address = register_string_to_int(cmd.operands[0]);
+			if (log)
+				logger_log(TRANSLATOR, OVERFLOW, line, "Label \"%s\" is too far!", label);
+			return TRANSLATOR_OVERFLOW;
 		}
-		else
+		*m |= FIELD(offset, IMMED_START, IMMED_END);
+	}
+	else /* J - put the address */
+	{
+		address = symbol_p->value;
+		if (!is_in_range_2_complement(address, I_INSTRUCTION_IMMED_SIZE_BITS))
 		{
-		    label = cmd.operands[0];
-			symbol_p = find_symbol(label, st);
-			if (!symbol_p)
-			{
-				logger_log(TRANSLATOR, PROBLEM_WITH_CODE, line, "Label \"%s\" does not exist", label);
-				return TRANSLATOR_LABEL_DOES_NOT_EXIST;
-			}
-
-			address = symbol_p->value;
-			if (!is_in_range_2_complement(address, I_INSTRUCTION_IMMED_SIZE_BITS))
-			{
+			if (log)
 				logger_log(TRANSLATOR, OVERFLOW, line, "Label \"%s\" is too far!", label);
-				return TRANSLATOR_OVERFLOW;
-			}
+			return TRANSLATOR_OVERFLOW;
 		}
+		*m |= FIELD(address, ADDRESS_START, ADDRESS_END);
 	}
 
-	bitmap_put_data(m, &address, ADDRESS_START, ADDRESS_END);
-	bitmap_put_data(m, &reg, REG_START, REG_END);
-
 	return TRANSLATOR_OK;
 }
 
-translator_status translator_translate(command cmd, symbols_table st, unsigned long ic, int line, machine_instruction *m)
+translator_status translator_translate(ir_record *record, symbols_table st, unsigned long ic, machine_instruction *m)
 {
-	instruction *inst;
-	instructions_table_get_instruction(cmd.command_name, &inst);
-	*m = 0;
-	if (inst->type == R)
-		translate_R_instruction(m, cmd, *inst);
-	else if (inst->type == I)
-		return translate_I_instruction(m, cmd, *inst, st, ic, line);
-	else /* J */
-		return translate_J_instruction(m, cmd, *inst, st, line);
+	instruction_type type;
+	char *label = translator_translate_partial(record, m, &type);
 
-	return TRANSLATOR_OK;
+	if (!label) /* There is nothing to resolve */
+		return TRANSLATOR_OK;
+
+	return translator_put_label(m, type, label, symbols_table_find(st, label), ic, record->line, true);
+}
+
+void translator_store(unsigned char *code_image, unsigned long index, machine_instruction m)
+{
+	code_image[index] = (unsigned char) m;
+	code_image[index + 1] = (unsigned char) (m >> BITS_PER_BYTE);
+	code_image[index + 2] = (unsigned char) (m >> (2 * BITS_PER_BYTE));
+	code_image[index + 3] = (unsigned char) (m >> (3 * BITS_PER_BYTE));
+}
+
+machine_instruction translator_load(unsigned char *code_image, unsigned long index)
+{
+	return (machine_instruction) code_image[index] |
+		   (machine_instruction) code_image[index + 1] << BITS_PER_BYTE |
+		   (machine_instruction) code_image[index + 2] << (2 * BITS_PER_BYTE) |
+		   (machine_instruction) code_image[index + 3] << (3 * BITS_PER_BYTE);
 }
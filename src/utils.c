@@ -1,41 +1,49 @@
 #include "utils.h"
-#include "string.h"
-#include "symbol.h"
-#include "linked_list.h"
-
-#include <math.h>
 
 #define FIRST_BYTE_MASK 0xFF /* Helps to extract the first byte from a number, by doing (num & FIRST_BYTE_MASK). */
 #define BITS_IN_BYTE 8       /* How many bits does each byte contain? */
 
 boolean is_in_range_2_complement(long num, int bits)
 {
-    long max = (long) (pow(2, bits - 1) - 1);
-    long min = (long) -pow(2, bits - 1);
+    long max = (1L << (bits - 1)) - 1;
+    long min = -max - 1;
 
     return (num <= max && num >= min);
 }
 
-void put_in_char_array(unsigned char *arr, long num, int size, unsigned long index)
+void put_numbers_in_char_array(unsigned char *arr, long *nums, unsigned long count, int size)
 {
-    int byte;
-    for (byte = 0; byte < size; byte++) /* Iterate on every required byte */
-    {
-        arr[index] = (unsigned char)(num & FIRST_BYTE_MASK);
-        index++;
-        num >>= BITS_IN_BYTE;
-    }
-}
+    unsigned long i, num;
 
-symbol *find_symbol(char *name, symbols_table st)
-{
-    int i;
-    for (i = 0; i < linked_list_length(st); i++)
+    /* A loop for every size, so each number is a few stores */
+    switch (size)
     {
-        symbol *symbol_p = linked_list_get(st, i);
-        if (strcmp(name, symbol_p->name) == 0)
-            return symbol_p;
-    }
+    case 1:
+        for (i = 0; i < count; i++)
+            arr[i] = (unsigned char)(nums[i] & FIRST_BYTE_MASK);
+        break;
+
+    case 2:
+        for (i = 0; i < count; i++, arr += 2)
+        {
+            num = (unsigned long) nums[i];
+            arr[0] = (unsigned char)(num & FIRST_BYTE_MASK);
+            arr[1] = (unsigned char)((num >> BITS_IN_BYTE) & FIRST_BYTE_MASK);
+        }
+        break;
+
+    case 4:
+        for (i = 0; i < count; i++, arr += 4)
+        {
+            num = (unsigned long) nums[i];
+            arr[0] = (unsigned char)(num & FIRST_BYTE_MASK);
+            arr[1] = (unsigned char)((num >> BITS_IN_BYTE) & FIRST_BYTE_MASK);
+            arr[2] = (unsigned char)((num >> (2 * BITS_IN_BYTE)) & FIRST_BYTE_MASK);
+            arr[3] = (unsigned char)((num >> (3 * BITS_IN_BYTE)) & FIRST_BYTE_MASK);
+        }
+        break;
 
-    return NULL;
-}
\ No newline at end of file
+    default: /* Will never happen */
+        break;
+    }
+}
@@ -51,30 +51,29 @@ validator_status validate_label(char *label, int line)
 }
 
 /**
- * Checks if the given command name exists - as a directive (TODO) or as a command.
- * @param command_name The command name to check. Must be not empty!
- * @param type         The type of the command - DIRECTIVE or INSTRUCTION.
- * @param line         On what line is this command name?
+ * Checks if the given command name exists - as a directive or as an instruction, and resolves it.
+ * @param cmd_p A pointer to the command. It's inst and dir are set - the one of it's type, and the other to NULL.
+ * @param line  On what line is this command name?
  * @return VALIDATOR_INVALID or VALIDATOR_OK.
  */
-validator_status validate_command_name(char *command_name, command_type type, int line)
+validator_status validate_command_name(command *cmd_p, int line)
 {
-    instruction* inst;
-    directive* dir;
+    cmd_p->inst = NULL;
+    cmd_p->dir = NULL;
 
-    if (type == INSTRUCTION)
+    if (cmd_p->type == INSTRUCTION)
     {
-        if (instructions_table_get_instruction(command_name, &inst) == IT_INSTRUCTION_NOT_FOUND)
+        if (instructions_table_get_instruction(cmd_p->command_name, &cmd_p->inst) == IT_INSTRUCTION_NOT_FOUND)
         {
-            logger_log(VALIDATOR, INVALID_COMMAND, line, "Instruction \"%s\" does not exist", command_name);
+            logger_log(VALIDATOR, INVALID_COMMAND, line, "Instruction \"%s\" does not exist", cmd_p->command_name);
             return VALIDATOR_INVALID;
         }
     }
     else /* Directive */
     {
-        if (directives_table_get_directive(command_name, &dir) == DT_DIRECTIVE_DOES_NOT_EXIST)  
+        if (directives_table_get_directive(cmd_p->command_name, &cmd_p->dir) == DT_DIRECTIVE_DOES_NOT_EXIST)
         {
-            logger_log(VALIDATOR, INVALID_COMMAND, line, "Directive \"%s\" does not exist", command_name);
+            logger_log(VALIDATOR, INVALID_COMMAND, line, "Directive \"%s\" does not exist", cmd_p->command_name);
             return VALIDATOR_INVALID;
         }
     }
@@ -82,18 +81,18 @@ validator_status validate_command_name(char *command_name, command_type type, in
     return VALIDATOR_OK;
 }
 
-validator_status validator_validate(command cmd, int line)
+validator_status validator_validate(command *cmd_p, int line)
 {
     validator_status status;
 
-    if (command_has_label(cmd))
-        if ((status = validate_label(cmd.label, line)) != VALIDATOR_OK)
+    if (command_has_label(*cmd_p))
+        if ((status = validate_label(cmd_p->label, line)) != VALIDATOR_OK)
             return status;
 
-    if ((status = validate_command_name(cmd.command_name, cmd.type, line)) != VALIDATOR_OK)
+    if ((status = validate_command_name(cmd_p, line)) != VALIDATOR_OK)
         return status;
 
-    if ((status = validate_operands(cmd, line)) != VALIDATOR_OK)
+    if ((status = validate_operands(*cmd_p, line)) != VALIDATOR_OK)
         return status;
 
     return VALIDATOR_OK;
@@ -2,53 +2,158 @@
 #include "parser.h"
 #include "validator.h"
 #include "logger.h"
-#include "linked_list.h"
+#include "source_file.h"
 #include "symbol.h"
+#include "symbols_table.h"
+#include "arena.h"
 
-#include <stdio.h>
 #include <string.h>
 
 #define WALK "Walk"
 #define PROBLEM_WITH_CODE "ProblemWithCode"
 
-/**
- * @brief This method reads the next line from file. Every line must be at most LINE_MAX_LENGTH chars.
- *        If the file is over, the buffer will be empty.
- * @param f   The file to read from.
- * @param buf The buffer to write into. Must be size of at least LINE_MAX_LENGTH + 1.
- * @return WALK_PROBLEM_WITH_CODE or WALK_EOF or WALK_OK
- */
-walk_status read_next_line(FILE *f, char *buf)
+#define IMAGE_MIN_SIZE 2048
+
+#define EXTERN_USES_MIN_CAPACITY 8
+
+#define RUNS_MIN_CAPACITY 8
+
+walk_status read_next_line(source_file *source, char *buf)
+{
+    line_view line;
+
+    if (source_file_next_line(source, &line) == SOURCE_FILE_EOF)
+        return WALK_EOF;
+
+    if (line.length > LINE_MAX_LENGTH)
+        return WALK_PROBLEM_WITH_CODE; /* The source already skipped the whole line */
+
+    memcpy(buf, line.start, line.length);
+    buf[line.length] = '\0';
+
+    return WALK_OK;
+}
+
+walk_status image_init(image *image_p, unsigned long capacity, arena *arena_p)
 {
-    int c;
-    int counter = 0;
-    while ((c = fgetc(f)) != EOF)
+    if (capacity == 0)
+        capacity = IMAGE_MIN_SIZE;
+
+    image_p->content = arena_alloc(arena_p, capacity);
+    if (!image_p->content)
+        return WALK_NOT_ENOUGH_MEMORY;
+    image_p->capacity = capacity;
+    image_p->runs = NULL;
+    image_p->runs_count = image_p->runs_capacity = image_p->runs_size = 0;
+
+    return WALK_OK;
+}
+
+walk_status image_reserve(image *image_p, unsigned long size, arena *arena_p)
+{
+    while (size > image_p->capacity)
     {
-        counter++;
-        if (c == '\n')
-            break;
+        unsigned char *new_content = arena_realloc(arena_p, image_p->content, image_p->capacity, image_p->capacity * 2);
+        if (!new_content)
+            return WALK_NOT_ENOUGH_MEMORY;
 
-        if (counter > LINE_MAX_LENGTH)
-        {
-            /* Read until the end of the line, and then return the error */
-            do
-            {
-                c = fgetc(f);
-            } while (c != EOF && c != '\n');
+        image_p->content = new_content;
+        image_p->capacity *= 2;
+    }
 
-            return WALK_PROBLEM_WITH_CODE;
-        }
+    return WALK_OK;
+}
+
+walk_status image_reserve_runs(image *image_p, unsigned long count, arena *arena_p)
+{
+    unsigned long new_capacity = image_p->runs_capacity ? image_p->runs_capacity : RUNS_MIN_CAPACITY;
+    data_run *new_runs;
+
+    if (count <= image_p->runs_capacity)
+        return WALK_OK;
+
+    while (new_capacity < count)
+        new_capacity *= 2;
+
+    new_runs = arena_realloc(arena_p, image_p->runs, image_p->runs_capacity * sizeof(data_run), new_capacity * sizeof(data_run));
+    if (!new_runs)
+        return WALK_NOT_ENOUGH_MEMORY;
+
+    image_p->runs = new_runs;
+    image_p->runs_capacity = new_capacity;
+    return WALK_OK;
+}
+
+walk_status image_add_run(image *image_p, unsigned long address, unsigned long count, long value, int size, arena *arena_p)
+{
+    data_run *run_p;
+
+    if (image_reserve_runs(image_p, image_p->runs_count + 1, arena_p) != WALK_OK)
+        return WALK_NOT_ENOUGH_MEMORY;
+
+    run_p = &image_p->runs[image_p->runs_count++];
+    run_p->address = address;
+    run_p->count = count;
+    run_p->value = value;
+    run_p->size = size;
+    run_p->runs_before = image_p->runs_size;
+    image_p->runs_size += count * size;
+
+    return WALK_OK;
+}
+
+walk_status add_extern_use(symbol *symbol_p, unsigned long ic, arena *arena_p)
+{
+    if (symbol_p->instructions_using_me_count == symbol_p->instructions_using_me_capacity)
+    {
+        unsigned long new_capacity = symbol_p->instructions_using_me_capacity * 2;
+        unsigned long *new_uses;
+
+        if (new_capacity < EXTERN_USES_MIN_CAPACITY)
+            new_capacity = EXTERN_USES_MIN_CAPACITY;
 
-        *buf++ = (char) c;
+        new_uses = arena_realloc(arena_p, symbol_p->instructions_using_me,
+                                 symbol_p->instructions_using_me_capacity * sizeof(unsigned long),
+                                 new_capacity * sizeof(unsigned long));
+        if (!new_uses)
+            return WALK_NOT_ENOUGH_MEMORY;
+
+        symbol_p->instructions_using_me = new_uses;
+        symbol_p->instructions_using_me_capacity = new_capacity;
     }
-    *buf = '\0';
-    
-    if (counter == 0)
-        return WALK_EOF;
 
+    symbol_p->instructions_using_me[symbol_p->instructions_using_me_count++] = ic;
     return WALK_OK;
 }
 
+void relocate_data_symbols(symbols_table st, unsigned long icf)
+{
+    unsigned long i;
+
+    for (i = 0; i < symbols_table_length(st); i++)
+    {
+        symbol *symbol_t = symbols_table_get(st, i);
+        if (symbol_t->type == DATA)
+            symbol_t->value += icf;
+    }
+}
+
+unsigned long run_size(command cmd)
+{
+    if (cmd.type != DIRECTIVE)
+        return 0;
+
+    switch (cmd.dir->id)
+    {
+    case DIRECTIVE_SPACE:
+        return (unsigned long) cmd.values[0] * BYTE;
+    case DIRECTIVE_FILL:
+        return (unsigned long) cmd.values[0] * (unsigned long) cmd.values[2];
+    default:
+        return 0;
+    }
+}
+
 void next_counter(unsigned long *pc, unsigned long *dc, command cmd)
 {
     if (cmd.type == INSTRUCTION)
@@ -58,57 +163,71 @@ void next_counter(unsigned long *pc, unsigned long *dc, command cmd)
         int unit_size; /* In bytes */
         size_t n;      /* How many data? */
 
-        if (strcmp(cmd.command_name, "entry") == 0 || strcmp(cmd.command_name, "extern") == 0)
-            return; /* There is nothing to do */
-
-        if (strcmp(cmd.command_name, "db") == 0 || strcmp(cmd.command_name, "asciz") == 0)
+        switch (cmd.dir->id)
+        {
+        case DIRECTIVE_DB:
             unit_size = BYTE;
-        else if (strcmp(cmd.command_name, "dh") == 0)
+            n = (size_t) cmd.number_of_operands;
+            break;
+        case DIRECTIVE_DH:
             unit_size = HALF;
-        else if (strcmp(cmd.command_name, "dw") == 0)
+            n = (size_t) cmd.number_of_operands;
+            break;
+        case DIRECTIVE_DW:
             unit_size = WORD;
-
-        if (strcmp(cmd.command_name, "asciz") == 0)
-            n = strlen(cmd.operands[0]) - 2 + 1; /* -2 - so it will not count the quotes. +1 - for the null terminator. */
-        else
             n = (size_t) cmd.number_of_operands;
+            break;
+        case DIRECTIVE_ASCIZ:
+            unit_size = BYTE;
+            n = strlen(cmd.operands[0]) - 2 + 1; /* -2 - so it will not count the quotes. +1 - for the null terminator. */
+            break;
+        case DIRECTIVE_SPACE:
+        case DIRECTIVE_FILL:
+            unit_size = BYTE;
+            n = (size_t) run_size(cmd);
+            break;
+        default: /* .entry or .extern - there is nothing to do */
+            return;
+        }
 
         *dc += n * unit_size;
     }
 }
 
-walk_status get_next_command(FILE *f, command *cmd, int* line_number, boolean validate)
+walk_status check_address_range(unsigned long pc, unsigned long dc, command cmd, int line)
+{
+    unsigned long next_pc = pc, next_dc = dc;
+
+    next_counter(&next_pc, &next_dc, cmd);
+    if (pc + dc - 1 <= ADDRESS_MAX && next_pc + next_dc - 1 > ADDRESS_MAX)
+    {
+        logger_log(WALK, PROBLEM_WITH_CODE, line, "The code and the data must fit into %d bit addresses, but this line ends at address %lu", ADDRESS_BITS, next_pc + next_dc - 1);
+        return WALK_PROBLEM_WITH_CODE;
+    }
+
+    return WALK_OK;
+}
+
+walk_status parse_line(command_buffer *buffer_p, walk_status read_status, command *cmd, int line_number, boolean validate)
 {
-    char line[LINE_MAX_LENGTH + 1]; /* +1 for the last '\0'. */
     parser_status p_status;
     validator_status v_status;
-    walk_status status;
 
-read_line:
-    (*line_number)++;
-    status = read_next_line(f, line);
-    if (status == WALK_PROBLEM_WITH_CODE)
+    if (read_status == WALK_PROBLEM_WITH_CODE)
     {
-        logger_log(WALK, PROBLEM_WITH_CODE, *line_number, "A line must be at most %d chars, including whitespaces", LINE_MAX_LENGTH);
+        logger_log(WALK, PROBLEM_WITH_CODE, line_number, "A line must be at most %d chars, including whitespaces", LINE_MAX_LENGTH);
         return WALK_PROBLEM_WITH_CODE;
     }
-    else if (status == WALK_EOF)
-        return status;
 
-    p_status = parser_parse(line, cmd, *line_number);
+    p_status = parser_parse(buffer_p, cmd, line_number);
     switch (p_status)
     {
     case PARSER_OVERFLOW:
     case PARSER_SYNTAX_ERROR:
-        free_command(*cmd);
         return WALK_PROBLEM_WITH_CODE;
-    case PARSER_NOT_ENOUGH_MEMORY:
-        free_command(*cmd);
-        return WALK_NOT_ENOUGH_MEMORY;
 
     case PARSER_EMPTY:
-        free_command(*cmd);
-        goto read_line; /* Try the next line */
+        return WALK_EMPTY_LINE;
 
     default:
         break;
@@ -116,27 +235,27 @@ read_line:
 
     if (validate)
     {
-        v_status = validator_validate(*cmd, *line_number);
+        v_status = validator_validate(cmd, line_number);
         if (v_status == VALIDATOR_INVALID)
-        {
-            free_command(*cmd);
             return WALK_PROBLEM_WITH_CODE;
-        }
     }
 
     return WALK_OK;
 }
 
-void free_symbols_table(symbols_table st) 
+walk_status get_next_command(source_file *source, command_buffer *buffer_p, command *cmd, int* line_number, boolean validate)
 {
-    int i;
-    for (i = 0; i < linked_list_length(st); i++)
+    walk_status status;
+
+    do /* Skip the empty lines */
     {
-        symbol* symbol_t = linked_list_get(st, i);
-        linked_list_free_elements(symbol_t->instructions_using_me);
-        linked_list_free(symbol_t->instructions_using_me);
-    }
+        (*line_number)++;
+        status = read_next_line(source, buffer_p->line);
+        if (status == WALK_EOF)
+            return status;
+
+        status = parse_line(buffer_p, status, cmd, *line_number, validate);
+    } while (status == WALK_EMPTY_LINE);
 
-    linked_list_free_elements(st);
-    linked_list_free(st);
+    return status;
 }
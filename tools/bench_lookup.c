@@ -0,0 +1,82 @@
+/**
+ * A microbenchmark of the instructions and directives lookups: the generated perfect hash (instructions_table.c and
+ * directives_table.c) against the linear strcmp() scan that was used before.
+ * Usage: "bench_lookup [iterations]"
+ */
+
+#include "instructions_table.h"
+#include "directives_table.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define DEFAULT_ITERATIONS 200000L
+
+static char *instructions_names[] = {
+#define INSTRUCTION(id, name, type, funct, opcode, number_of_operands, operands_types) name,
+#include "instructions_list.h"
+#undef INSTRUCTION
+};
+
+static char *directives_names[] = {
+#define DIRECTIVE(id, name, number_of_operands, operands_types) name,
+#include "directives_list.h"
+#undef DIRECTIVE
+};
+
+#define LENGTH_OF_ARRAY(arr) (sizeof(arr) / sizeof((arr)[0]))
+
+/* What is looked up: every instruction and directive, and some labels (the validator checks that labels are not
+   reserved words, so misses are common too) */
+static char *workload[] = {
+    "add", "sub", "and", "or", "nor", "move", "mvhi", "mvlo", "addi", "subi", "andi", "ori", "nori", "bne", "beq",
+    "blt", "bgt", "lb", "sb", "lw", "sw", "lh", "sh", "jmp", "la", "call", "stop", "db", "dh", "dw", "asciz", "space",
+    "fill", "entry", "extern", "LOOP", "MAIN", "END", "STR", "Next", "LIST", "K", "val1", "wNumber", "x", "arrayOfNumbersNumber7"};
+
+/**
+ * @brief The old lookup - a linear scan with strcmp().
+ */
+static int linear_scan(char **names, int length, char *name)
+{
+    int i;
+
+    for (i = 0; i < length; i++)
+        if (strcmp(names[i], name) == 0)
+            return i;
+
+    return -1;
+}
+
+int main(int argc, char *argv[])
+{
+    long iterations = argc > 1 ? atol(argv[1]) : DEFAULT_ITERATIONS;
+    long i, found = 0;
+    int j;
+    clock_t start;
+    double scan_seconds, hash_seconds;
+    instruction *inst;
+    directive *dir;
+
+    /* Every lookup does both tables, like validate_label() */
+    start = clock();
+    for (i = 0; i < iterations; i++)
+        for (j = 0; j < (int)LENGTH_OF_ARRAY(workload); j++)
+            found += (linear_scan(instructions_names, LENGTH_OF_ARRAY(instructions_names), workload[j]) >= 0) +
+                     (linear_scan(directives_names, LENGTH_OF_ARRAY(directives_names), workload[j]) >= 0);
+    scan_seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (i = 0; i < iterations; i++)
+        for (j = 0; j < (int)LENGTH_OF_ARRAY(workload); j++)
+            found += (instructions_table_get_instruction(workload[j], &inst) == IT_OK) +
+                     (directives_table_get_directive(workload[j], &dir) == DT_OK);
+    hash_seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    printf("%ld lookups in each table (%ld found)\n", iterations * (long)LENGTH_OF_ARRAY(workload), found);
+    printf("Linear scan:  %.3f s\n", scan_seconds);
+    printf("Perfect hash: %.3f s (%.2fx)\n", hash_seconds, hash_seconds > 0 ? scan_seconds / hash_seconds : 0);
+
+    return 0;
+}
@@ -0,0 +1,192 @@
+/**
+ * A benchmark of the input scanning: splitting a big synthetic source into lines (And checking the 80 chars limit, like
+ * read_next_line() does) with source_file_next_line() - which finds the newlines a block at a time - against a memchr()
+ * for every line, and against a byte loop.
+ * Usage: "bench_scan [megabytes]"
+ */
+
+#include "source_file.h"
+#include "command.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define DEFAULT_MEGABYTES 256
+#define MEGABYTE (1024L * 1024L)
+
+#define LENGTH_OF_ARRAY(arr) (sizeof(arr) / sizeof((arr)[0]))
+
+/* What a generated source looks like */
+static char *lines[] = {
+    "MAIN:   add $3, $5, $9",
+    "LOOP:   ori $9, -5, $2",
+    "        la val1",
+    "        jmp Next",
+    "Next:   move $20, $4",
+    "LIST:   .db 6, -9",
+    "        bgt $4, $2, END",
+    "        la K",
+    "        sw $0, 4, $10",
+    "        bne $31, $9, LOOP",
+    "        call val1",
+    "        jmp $4",
+    "        la wNumber",
+    "STR:    .asciz \"aBcd\"",
+    "        .dh 27056",
+    "K:      .dw 31, -12",
+    "; A comment",
+    "",
+    "END:    stop",
+    "        .entry LOOP",
+    "        .extern val1",
+    "        .db 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23"
+};
+
+typedef struct s_scan_result
+{
+    long lines;          /**< How many lines? */
+    long long_lines;     /**< How many lines are longer than LINE_MAX_LENGTH? */
+    unsigned long chars; /**< The sum of the lengths of the lines. */
+} scan_result;
+
+/**
+ * @brief Generates a source of (About) the given size.
+ */
+static char *generate(size_t size, size_t *generated_size_p)
+{
+    char *content = malloc(size + LINE_MAX_LENGTH * 2);
+    size_t position = 0;
+    unsigned long seed = 1;
+
+    if (!content)
+        return NULL;
+
+    while (position < size)
+    {
+        char *line;
+        size_t length;
+
+        seed = seed * 1103515245UL + 12345UL;
+        line = lines[(seed >> 16) % LENGTH_OF_ARRAY(lines)];
+        length = strlen(line);
+        memcpy(content + position, line, length);
+        content[position + length] = '\n';
+        position += length + 1;
+    }
+
+    *generated_size_p = position;
+    return content;
+}
+
+/**
+ * @brief Adds a line to the result.
+ */
+static void count_line(scan_result *result_p, size_t length)
+{
+    result_p->lines++;
+    result_p->chars += length;
+    if (length > LINE_MAX_LENGTH)
+        result_p->long_lines++;
+}
+
+/**
+ * @brief Splits with source_file_next_line().
+ */
+static void scan_blocks(char *content, size_t size, scan_result *result_p)
+{
+    source_file source;
+    line_view line;
+
+    source_file_from_buffer(content, size, &source);
+    while (source_file_next_line(&source, &line) == SOURCE_FILE_OK)
+        count_line(result_p, line.length);
+}
+
+/**
+ * @brief Splits with a memchr() for every line.
+ */
+static void scan_memchr(char *content, size_t size, scan_result *result_p)
+{
+    size_t position = 0;
+
+    while (position < size)
+    {
+        char *newline = memchr(content + position, '\n', size - position);
+        size_t length = newline ? (size_t) (newline - content) - position : size - position;
+
+        count_line(result_p, length);
+        position += length + 1;
+    }
+}
+
+/**
+ * @brief Splits with a byte loop.
+ */
+static void scan_bytes(char *content, size_t size, scan_result *result_p)
+{
+    size_t position = 0, start = 0;
+
+    for (position = 0; position < size; position++)
+    {
+        if (content[position] == '\n')
+        {
+            count_line(result_p, position - start);
+            start = position + 1;
+        }
+    }
+    if (start < size)
+        count_line(result_p, size - start);
+}
+
+/**
+ * @brief Runs one of the scans, and prints it's throughput.
+ */
+static double run(char *name, void (*scan)(char *, size_t, scan_result *), char *content, size_t size, scan_result *result_p)
+{
+    clock_t start;
+    double seconds;
+
+    memset(result_p, 0, sizeof(scan_result));
+    start = clock();
+    scan(content, size, result_p);
+    seconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+
+    printf("%-12s %.3f s, %8.1f MB/s (%ld lines, %ld too long)\n", name, seconds,
+           seconds > 0 ? (double) size / MEGABYTE / seconds : 0, result_p->lines, result_p->long_lines);
+    return seconds;
+}
+
+int main(int argc, char *argv[])
+{
+    long megabytes = argc > 1 ? atol(argv[1]) : DEFAULT_MEGABYTES;
+    size_t size;
+    char *content;
+    scan_result bytes_result, memchr_result, blocks_result;
+    double bytes_seconds, memchr_seconds, blocks_seconds;
+
+    content = generate((size_t) megabytes * MEGABYTE, &size);
+    if (!content)
+    {
+        printf("Not enough memory for %ld MB\n", megabytes);
+        return 1;
+    }
+
+    printf("Splitting %.1f MB into lines\n", (double) size / MEGABYTE);
+    bytes_seconds = run("Byte loop:", scan_bytes, content, size, &bytes_result);
+    memchr_seconds = run("memchr():", scan_memchr, content, size, &memchr_result);
+    blocks_seconds = run("Blocks:", scan_blocks, content, size, &blocks_result);
+    if (blocks_seconds > 0)
+        printf("Blocks against the byte loop: %.2fx, against memchr(): %.2fx\n", bytes_seconds / blocks_seconds, memchr_seconds / blocks_seconds);
+
+    free(content);
+
+    if (memcmp(&bytes_result, &blocks_result, sizeof(scan_result)) != 0 || memcmp(&memchr_result, &blocks_result, sizeof(scan_result)) != 0)
+    {
+        printf("The scans do not agree!\n");
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,171 @@
+/**
+ * This tool generates the minimal perfect hash tables of the instructions and of the directives, at build time.
+ * Usage: "gen_perfect_hash instructions|directives > <name>_hash.h"
+ *
+ * It uses the CHM algorithm: every key i is an edge (h1(key), h2(key)) in a graph of <vertices> vertices. Seeds are
+ * tried until the graph is acyclic, and then g[] is filled by walking each tree, so that
+ * (g[h1] + g[h2]) % number_of_keys == i for every key. See perfect_hash.h.
+ */
+
+#include "perfect_hash.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_KEYS 255       /* g[] is an array of unsigned chars */
+#define MAX_ATTEMPTS 100000
+#define VERTICES_PER_KEY 2 /* (2 * keys + 1) vertices - CHM needs more than 2 vertices per key to find an acyclic graph */
+
+static char *instructions_keys[] = {
+#define INSTRUCTION(id, name, type, funct, opcode, number_of_operands, operands_types) name,
+#include "instructions_list.h"
+#undef INSTRUCTION
+};
+
+static char *directives_keys[] = {
+#define DIRECTIVE(id, name, number_of_operands, operands_types) name,
+#include "directives_list.h"
+#undef DIRECTIVE
+};
+
+#define LENGTH_OF_ARRAY(arr) (sizeof(arr) / sizeof((arr)[0]))
+
+typedef struct s_edge
+{
+    unsigned long u, v; /* The vertices */
+} edge;
+
+/**
+ * @brief Finds the root of the given vertex in the union-find forest.
+ */
+static unsigned long find_root(unsigned long *parent, unsigned long vertex)
+{
+    while (parent[vertex] != vertex)
+        vertex = parent[vertex] = parent[parent[vertex]];
+
+    return vertex;
+}
+
+/**
+ * @brief Builds the graph of the given seeds.
+ *
+ * @return int 1 if the graph is acyclic (And then the seeds are good), 0 otherwise.
+ */
+static int build_graph(char **keys, unsigned long n, unsigned long vertices, unsigned long seed1, unsigned long seed2, edge *edges, unsigned long *parent)
+{
+    unsigned long i, h1, h2, root1, root2;
+
+    for (i = 0; i < vertices; i++)
+        parent[i] = i;
+
+    for (i = 0; i < n; i++)
+    {
+        perfect_hash_string(keys[i], seed1, seed2, &h1, &h2);
+        edges[i].u = h1 % vertices;
+        edges[i].v = h2 % vertices;
+
+        root1 = find_root(parent, edges[i].u);
+        root2 = find_root(parent, edges[i].v);
+        if (root1 == root2) /* A self loop, or a cycle */
+            return 0;
+        parent[root1] = root2;
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Fills g[] for the tree that contains <vertex>, assuming g[vertex] is already set.
+ */
+static void assign_tree(unsigned long vertex, unsigned long n, edge *edges, unsigned long *g, int *visited, unsigned long *stack)
+{
+    unsigned long top = 0, i, other;
+
+    visited[vertex] = 1;
+    stack[top++] = vertex;
+
+    while (top > 0)
+    {
+        vertex = stack[--top];
+        for (i = 0; i < n; i++)
+        {
+            if (edges[i].u == vertex)
+                other = edges[i].v;
+            else if (edges[i].v == vertex)
+                other = edges[i].u;
+            else
+                continue;
+
+            if (visited[other])
+                continue;
+
+            /* (g[vertex] + g[other]) % n must be i */
+            g[other] = (i + n - g[vertex]) % n;
+            visited[other] = 1;
+            stack[top++] = other;
+        }
+    }
+}
+
+/**
+ * @brief Generates and prints the perfect hash table of the given keys.
+ *
+ * @return int 0 on success, 1 on failure.
+ */
+static int generate(char *table_name, char **keys, unsigned long n)
+{
+    unsigned long vertices = VERTICES_PER_KEY * n + 1;
+    unsigned long seed1, seed2, i, attempt;
+    edge *edges = malloc(n * sizeof(edge));
+    unsigned long *parent = malloc(vertices * sizeof(unsigned long));
+    unsigned long *g = calloc(vertices, sizeof(unsigned long));
+    unsigned long *stack = malloc(vertices * sizeof(unsigned long));
+    int *visited = calloc(vertices, sizeof(int));
+
+    if (!edges || !parent || !g || !stack || !visited || n > MAX_KEYS)
+        return 1;
+
+    for (attempt = 0; attempt < MAX_ATTEMPTS; attempt++)
+    {
+        seed1 = 2166136261UL + attempt * 2;
+        seed2 = 2166136261UL + attempt * 2 + 1;
+        if (build_graph(keys, n, vertices, seed1, seed2, edges, parent))
+            break;
+    }
+    if (attempt == MAX_ATTEMPTS)
+    {
+        fprintf(stderr, "Error: Cannot find a perfect hash for the %s.\n", table_name);
+        return 1;
+    }
+
+    for (i = 0; i < vertices; i++)
+        if (!visited[i])
+            assign_tree(i, n, edges, g, visited, stack);
+
+    printf("/* Generated by tools/gen_perfect_hash.c from %s_list.h - DO NOT EDIT! */\n\n", table_name);
+    printf("static const unsigned char %s_hash_g[] = {", table_name);
+    for (i = 0; i < vertices; i++)
+        printf("%s%lu", i ? ", " : "", g[i]);
+    printf("};\n\n");
+    printf("static const perfect_hash_table %s_hash = {%luUL, %luUL, %luUL, %luUL, %s_hash_g};\n",
+           table_name, seed1, seed2, vertices, n, table_name);
+
+    free(edges);
+    free(parent);
+    free(g);
+    free(stack);
+    free(visited);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc == 2 && strcmp(argv[1], "instructions") == 0)
+        return generate(argv[1], instructions_keys, LENGTH_OF_ARRAY(instructions_keys));
+    if (argc == 2 && strcmp(argv[1], "directives") == 0)
+        return generate(argv[1], directives_keys, LENGTH_OF_ARRAY(directives_keys));
+
+    fprintf(stderr, "Usage: \"%s instructions|directives\"\n", argv[0]);
+    return 1;
+}
@@ -0,0 +1,379 @@
+/**
+ * This tool converts between the text object format (".ob", with it's ".ent" and ".ext" files) and the binary object
+ * format (".obb"). See obb.h.
+ * Usage: "obb_convert file.ob ..." writes file.obb (With the entries / externals tables if file.ent / file.ext exist);
+ *        "obb_convert file.obb ..." writes file.ob (And file.ent / file.ext if the tables exist).
+ */
+
+#include "obb.h"
+#include "walk.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define OBJECT_EXT        "ob"
+#define BINARY_OBJECT_EXT "obb"
+#define ENTRIES_EXT       "ent"
+#define EXTERNALS_EXT     "ext"
+
+#define OBJECT_FILE_BYTES_PER_LINE 4
+
+#define MAX_LINE_LENGTH 256
+
+/**
+ * @brief Returns the given file name, with the extension changed to <new_ext>.
+ *
+ * @param file_name The file name. Must have an extension.
+ * @param new_ext   The new extension.
+ * @return char* The new file name, or NULL if there is not enough memory. THE MEMORY MUST BE FREED AFTER USAGE!
+ */
+static char *change_extension(char *file_name, char *new_ext)
+{
+    size_t base_length = (size_t) (strrchr(file_name, '.') - file_name) + 1; /* +1 - Keep the '.' */
+    char *new_file_name = malloc(base_length + strlen(new_ext) + 1);
+    if (!new_file_name)
+        return NULL;
+
+    memcpy(new_file_name, file_name, base_length);
+    strcpy(new_file_name + base_length, new_ext);
+
+    return new_file_name;
+}
+
+/**
+ * @brief Reads the rows of an ".ent" or ".ext" file, and encodes them as rows of an ".obb" table.
+ *
+ * @param file_name The name of the file.
+ * @param table     A pointer to where to put the encoded table. Allocated by malloc(), MUST BE FREED.
+ * @param count     A pointer to where to put the number of rows.
+ * @return int 1 if the table was read, 0 if the file does not exist, -1 on an error (It is printed).
+ */
+static int read_symbols_file(char *file_name, unsigned char **table, unsigned long *count)
+{
+    char line[MAX_LINE_LENGTH], name[MAX_LINE_LENGTH];
+    unsigned long address, capacity = 0;
+    FILE *file = fopen(file_name, "r");
+
+    *table = NULL;
+    *count = 0;
+    if (!file)
+        return 0;
+
+    while (fgets(line, sizeof(line), file))
+    {
+        if (sscanf(line, "%s %lu", name, &address) != 2)
+        {
+            fprintf(stderr, "Error: \"%s\" has an invalid row: %s", file_name, line);
+            fclose(file);
+            free(*table);
+            return -1;
+        }
+
+        if (*count == capacity)
+        {
+            unsigned char *new_table;
+            capacity = capacity ? capacity * 2 : 16;
+            new_table = realloc(*table, capacity * OBB_SYMBOL_ROW_SIZE);
+            if (!new_table)
+            {
+                fprintf(stderr, "Error: Not enough memory!\n");
+                fclose(file);
+                free(*table);
+                return -1;
+            }
+            *table = new_table;
+        }
+
+        obb_encode_symbol_row(name, address, *table + *count * OBB_SYMBOL_ROW_SIZE);
+        (*count)++;
+    }
+
+    fclose(file);
+    return 1;
+}
+
+/**
+ * @brief Reads an ".ob" file.
+ *
+ * @param file_name The name of the file.
+ * @param header    The header to fill - code_address, icf and dcf.
+ * @param images    A pointer to where to put the code image, followed by the data image. Allocated by malloc(), MUST BE FREED.
+ * @return int 1 on success, 0 on an error (It is printed).
+ */
+static int read_object_file(char *file_name, obb_header *header, unsigned char **images)
+{
+    char line[MAX_LINE_LENGTH];
+    unsigned long code_size, size, count = 0;
+    FILE *file = fopen(file_name, "r");
+
+    if (!file)
+    {
+        fprintf(stderr, "Error: Cannot open file \"%s\".\n", file_name);
+        return 0;
+    }
+
+    if (!fgets(line, sizeof(line), file) || sscanf(line, "%lu %lu", &code_size, &header->dcf) != 2)
+        goto invalid;
+    size = code_size + header->dcf;
+
+    *images = malloc(size ? size : 1);
+    if (!*images)
+    {
+        fprintf(stderr, "Error: Not enough memory!\n");
+        fclose(file);
+        return 0;
+    }
+
+    /* Every row is an address, and then up to OBJECT_FILE_BYTES_PER_LINE bytes in hex. The addresses are sequential. */
+    header->code_address = IC_DEFAULT_VALUE;
+    while (fgets(line, sizeof(line), file))
+    {
+        char *p = line, *end;
+        unsigned long address = strtoul(p, &end, 10);
+        int i;
+
+        if (end == p)
+            goto invalid_free;
+        if (count == 0)
+            header->code_address = address;
+        else if (address != header->code_address + count)
+            goto invalid_free;
+
+        for (i = 0, p = end; i < OBJECT_FILE_BYTES_PER_LINE; i++, p = end)
+        {
+            unsigned long byte = strtoul(p, &end, 16);
+            if (end == p)
+                break;
+            if (byte > 0xFF || count == size)
+                goto invalid_free;
+            (*images)[count++] = (unsigned char) byte;
+        }
+    }
+
+    if (count != size)
+        goto invalid_free;
+
+    header->icf = header->code_address + code_size;
+    fclose(file);
+    return 1;
+
+invalid_free:
+    free(*images);
+invalid:
+    fprintf(stderr, "Error: \"%s\" is not a valid object file.\n", file_name);
+    fclose(file);
+    return 0;
+}
+
+/**
+ * @brief Converts an ".ob" file (And it's ".ent" and ".ext" files, if they exist) to an ".obb" file.
+ *
+ * @param file_name The name of the ".ob" file.
+ * @return int 1 on success, 0 on an error (It is printed).
+ */
+static int convert_to_binary(char *file_name)
+{
+    obb_header header;
+    unsigned char *images, *entries = NULL, *externals = NULL;
+    unsigned char encoded_header[OBB_HEADER_SIZE];
+    static unsigned char padding[OBB_ALIGNMENT];
+    char *entries_name, *externals_name, *binary_name;
+    int entries_status = -1, externals_status = -1, success = 0;
+    FILE *file;
+
+    if (!read_object_file(file_name, &header, &images))
+        return 0;
+
+    entries_name = change_extension(file_name, ENTRIES_EXT);
+    externals_name = change_extension(file_name, EXTERNALS_EXT);
+    binary_name = change_extension(file_name, BINARY_OBJECT_EXT);
+    if (!entries_name || !externals_name || !binary_name)
+    {
+        fprintf(stderr, "Error: Not enough memory!\n");
+        goto clean_up;
+    }
+
+    entries_status = read_symbols_file(entries_name, &entries, &header.entries_count);
+    externals_status = read_symbols_file(externals_name, &externals, &header.externals_count);
+    if (entries_status < 0 || externals_status < 0)
+        goto clean_up;
+
+    header.version = OBB_VERSION;
+    header.flags = (entries_status ? OBB_FLAG_ENTRIES : 0) | (externals_status ? OBB_FLAG_EXTERNALS : 0);
+    obb_encode_header(&header, encoded_header);
+
+    file = fopen(binary_name, "wb");
+    if (!file)
+    {
+        fprintf(stderr, "Error: Cannot open file \"%s\".\n", binary_name);
+        goto clean_up;
+    }
+    fwrite(encoded_header, 1, OBB_HEADER_SIZE, file);
+    fwrite(images, 1, header.icf - header.code_address + header.dcf, file);
+    fwrite(padding, 1, obb_padding_size(&header), file);
+    if (entries)
+        fwrite(entries, OBB_SYMBOL_ROW_SIZE, header.entries_count, file);
+    if (externals)
+        fwrite(externals, OBB_SYMBOL_ROW_SIZE, header.externals_count, file);
+    success = !ferror(file);
+    if (fclose(file) != 0 || !success)
+    {
+        fprintf(stderr, "Error: Cannot write file \"%s\".\n", binary_name);
+        success = 0;
+    }
+
+clean_up:
+    free(images);
+    free(entries);
+    free(externals);
+    free(entries_name);
+    free(externals_name);
+    free(binary_name);
+    return success;
+}
+
+/**
+ * @brief Writes the given image in the ".ob" format - a row of OBJECT_FILE_BYTES_PER_LINE bytes, starting with the
+ *        address of it's first byte. Only full rows end with '\n'.
+ *
+ * @param file          The file to write into.
+ * @param image         The image.
+ * @param length        The length of the image.
+ * @param first_address The address of the first byte of the image.
+ */
+static void write_image(FILE *file, unsigned char *image, unsigned long length, unsigned long first_address)
+{
+    unsigned long i;
+
+    for (i = 0; i < length; i++)
+    {
+        if (i % OBJECT_FILE_BYTES_PER_LINE == 0)
+            fprintf(file, "%04lu", first_address + i);
+        fprintf(file, " %-2.2X", image[i]);
+        if ((i + 1) % OBJECT_FILE_BYTES_PER_LINE == 0)
+            fprintf(file, "\n");
+    }
+}
+
+/**
+ * @brief Writes a table of the given ".obb" file as an ".ent" or ".ext" file.
+ *
+ * @param file_name  The name of the file to write.
+ * @param obb_p      The ".obb" file.
+ * @param count      How many rows are in the table?
+ * @param get_symbol obb_get_entry or obb_get_external.
+ * @return int 1 on success, 0 on an error (It is printed).
+ */
+static int write_symbols_file(char *file_name, obb_file *obb_p, unsigned long count, void (*get_symbol)(obb_file *, unsigned long, obb_symbol *))
+{
+    unsigned long i;
+    obb_symbol symbol;
+    FILE *file = fopen(file_name, "w");
+
+    if (!file)
+    {
+        fprintf(stderr, "Error: Cannot open file \"%s\".\n", file_name);
+        return 0;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        get_symbol(obb_p, i, &symbol);
+        fprintf(file, "%s %04lu\n", symbol.name, symbol.address);
+    }
+
+    fclose(file);
+    return 1;
+}
+
+/**
+ * @brief Converts an ".obb" file to an ".ob" file (And ".ent" and ".ext" files, if it has their tables).
+ *
+ * @param file_name The name of the ".obb" file.
+ * @return int 1 on success, 0 on an error (It is printed).
+ */
+static int convert_to_text(char *file_name)
+{
+    obb_file obb;
+    obb_header *header = &obb.header;
+    char *object_name, *entries_name, *externals_name;
+    int success = 0;
+    FILE *file;
+
+    switch (obb_open(file_name, &obb))
+    {
+    case OBB_IO_ERROR:
+        fprintf(stderr, "Error: Cannot open file \"%s\".\n", file_name);
+        return 0;
+    case OBB_NOT_ENOUGH_MEMORY:
+        fprintf(stderr, "Error: Not enough memory!\n");
+        return 0;
+    case OBB_INVALID:
+        fprintf(stderr, "Error: \"%s\" is not a valid binary object file.\n", file_name);
+        return 0;
+    default:
+        break;
+    }
+
+    object_name = change_extension(file_name, OBJECT_EXT);
+    entries_name = change_extension(file_name, ENTRIES_EXT);
+    externals_name = change_extension(file_name, EXTERNALS_EXT);
+    if (!object_name || !entries_name || !externals_name)
+    {
+        fprintf(stderr, "Error: Not enough memory!\n");
+        goto clean_up;
+    }
+
+    file = fopen(object_name, "w");
+    if (!file)
+    {
+        fprintf(stderr, "Error: Cannot open file \"%s\".\n", object_name);
+        goto clean_up;
+    }
+    fprintf(file, "%lu %lu\n", header->icf - header->code_address, header->dcf);
+    write_image(file, obb.code_image, header->icf - header->code_address, header->code_address);
+    write_image(file, obb.data_image, header->dcf, header->icf);
+    fclose(file);
+
+    success = 1;
+    if (header->flags & OBB_FLAG_ENTRIES)
+        success &= write_symbols_file(entries_name, &obb, header->entries_count, obb_get_entry);
+    if (header->flags & OBB_FLAG_EXTERNALS)
+        success &= write_symbols_file(externals_name, &obb, header->externals_count, obb_get_external);
+
+clean_up:
+    free(object_name);
+    free(entries_name);
+    free(externals_name);
+    obb_close(&obb);
+    return success;
+}
+
+int main(int argc, char *argv[])
+{
+    int i, status = 0;
+
+    if (argc == 1)
+    {
+        fprintf(stderr, "Usage: \"%s file1.ob|file1.obb file2.ob|file2.obb ...\"\n", argv[0]);
+        return 1;
+    }
+
+    for (i = 1; i < argc; i++)
+    {
+        char *dot = strrchr(argv[i], '.');
+
+        if (dot && strcmp(dot + 1, OBJECT_EXT) == 0)
+            status |= !convert_to_binary(argv[i]);
+        else if (dot && strcmp(dot + 1, BINARY_OBJECT_EXT) == 0)
+            status |= !convert_to_text(argv[i]);
+        else
+        {
+            fprintf(stderr, "Error: File \"%s\" is not \".%s\" nor \".%s\". Skipping.\n", argv[i], OBJECT_EXT, BINARY_OBJECT_EXT);
+            status = 1;
+        }
+    }
+
+    return status;
+}